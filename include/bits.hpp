@@ -0,0 +1,69 @@
+#ifndef __BITS_HPP__
+#define __BITS_HPP__ 1
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Bit counting helpers shared by the bit-packed generators. GCC and Clang use their builtins;
+// MSVC uses its intrinsics, and a portable fallback covers everything else.
+
+/**
+ * @brief Counts the set bits of a word.
+ */
+inline int popcount64(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX2__)
+    // POPCNT is only guaranteed on the CPUs that the AVX2 and AVX-512 builds require
+    return static_cast<int>(__popcnt64(v));
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return static_cast<int>((v * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/**
+ * @brief Gets the index of the lowest set bit of a word, which must not be 0.
+ */
+inline int ctz64(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return static_cast<int>(index);
+#else
+    // Position of the isolated lowest bit, by binary search
+    v &= 0 - v;
+    int n = 0;
+    if (v & 0xffffffff00000000ull) n += 32;
+    if (v & 0xffff0000ffff0000ull) n += 16;
+    if (v & 0xff00ff00ff00ff00ull) n += 8;
+    if (v & 0xf0f0f0f0f0f0f0f0ull) n += 4;
+    if (v & 0xccccccccccccccccull) n += 2;
+    if (v & 0xaaaaaaaaaaaaaaaaull) n += 1;
+    return n;
+#endif
+}
+
+/**
+ * @brief Gets the index of the lowest set bit of a 32-bit value, which must not be 0.
+ */
+inline int ctz32(std::uint32_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(v);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return static_cast<int>(index);
+#else
+    return ctz64(v);
+#endif
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef __BLUENOISE_HPP__
+#define __BLUENOISE_HPP__ 1
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+ * @class BlueNoise
+ * @brief Generates blue-noise threshold masks with the void-and-cluster algorithm (Ulichney).
+ *
+ * Every pixel receives a rank: thresholding the mask at any level gives a pattern whose points
+ * are evenly spread, without the clumps of white noise or the grid of ordered dithering. This
+ * makes it a good dither matrix for 8-bit exports and a source of well-spread jitter for
+ * supersampling.
+ *
+ * The energy of the current pattern (a Gaussian splat around each point) is built once with a
+ * separable filter and then updated incrementally inside the kernel window each time a point
+ * is added or removed. The tightest cluster and the largest void of each 8x8 block of pixels
+ * are the leaves of a tournament tree whose root holds those of the whole mask, so each step
+ * rescans only the blocks the window touched and replays their paths to the root.
+ * A 1024x1024 mask takes a few seconds.
+ */
+class BlueNoise {
+public:
+    /**
+     * @brief Constructor for the blue-noise mask generator.
+     *
+     * @param w Width of the mask.
+     * @param h Height of the mask.
+     */
+    BlueNoise(unsigned int w, unsigned int h);
+
+    /**
+     * @brief Generates the mask as a grayscale image.
+     *
+     * @param imageName File name where the generated image will be saved. The name is generated automatically.
+     *
+     * @return std::vector<unsigned char> A vector representing the generated image in RGBA format.
+     */
+    std::vector<unsigned char> generateImage(std::string& imageName);
+    /**
+     * @brief Renders a rectangular region of the mask into an existing buffer.
+     *
+     * The mask is generated on the first call after a parameter changes and then reused.
+     *
+     * @param image RGBA buffer of `width * height * 4` bytes.
+     * @param x0 Left edge of the region (inclusive).
+     * @param y0 Top edge of the region (inclusive).
+     * @param x1 Right edge of the region (exclusive).
+     * @param y1 Bottom edge of the region (exclusive).
+     * @param step Sample spacing in pixels; each sample fills a `step x step` block (default value: 1).
+     * @param detail Unused (default value: 1.0).
+     */
+    void renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+        unsigned int x1, unsigned int y1, unsigned int step = 1, float detail = 1.0f);
+
+    /**
+     * @brief Sets the standard deviation of the Gaussian energy kernel.
+     *
+     * @param s Sigma in pixels (default value: 1.5). Larger values spread the points more
+     * evenly at the cost of more work per step.
+     */
+    void setSigma(float s) { sigma = s; dirty = true; }
+    /**
+     * @brief Sets the seed of the initial random pattern. The same seed and size give the same
+     * mask on every platform.
+     *
+     * @param s Seed (default value: 0).
+     */
+    void setSeed(unsigned int s) { seed = s; dirty = true; }
+    /**
+     * @brief Makes the mask tileable: distances wrap around the edges.
+     *
+     * Otherwise the energy near the edges is compared relative to the part of the kernel that
+     * lies inside the mask, so the border is ranked like the interior.
+     *
+     * @param enabled Whether the mask tiles seamlessly. Default: true.
+     */
+    void setTileable(bool enabled) { tileable = enabled; dirty = true; }
+
+    /**
+     * @brief Gets the mask, generating it if needed.
+     *
+     * @return const std::vector<float>& `width * height` thresholds, row by row: the pixel of
+     * rank `r` holds `(r + 0.5) / (width * height)`, so the values are uniform in (0, 1). Empty
+     * when the width or the height is 0.
+     */
+    const std::vector<float>& mask();
+    /**
+     * @brief Gets the threshold at a pixel, repeating the mask over the plane.
+     *
+     * @param x X-coordinate, any value.
+     * @param y Y-coordinate, any value.
+     * @return float Threshold in (0, 1).
+     */
+    float at(unsigned int x, unsigned int y) { return mask()[(y % height) * width + x % width]; }
+
+private:
+    unsigned int width, height;
+    float sigma;
+    unsigned int seed;
+    bool tileable;
+    bool dirty;                  ///< Whether the mask must be generated again.
+    std::vector<float> thresholds;
+
+    /**
+     * @brief Runs void-and-cluster and fills `thresholds`.
+     */
+    void generate();
+};
+
+#endif
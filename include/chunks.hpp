@@ -0,0 +1,344 @@
+#ifndef __CHUNKS_HPP__
+#define __CHUNKS_HPP__ 1
+
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @class ChunkStreamer
+ * @brief Streams a large noise landscape as square chunks rendered on demand.
+ *
+ * The world plane is cut into `chunkSize x chunkSize` pixel chunks addressed by integer chunk
+ * coordinates: chunk `(cx, cy)` covers the world pixels starting at `(cx * chunkSize,
+ * cy * chunkSize)`. Chunks are rendered with setOrigin() and renderRegion(), so they join
+ * without seams, and kept in a least-recently-used cache that never grows past a memory cap.
+ *
+ * The world is large but not unbounded. The generators sample the noise in float, whose step
+ * at world pixel `x` is about `x / 2^23` pixels, so views should stay within kMaxCoordinate
+ * pixels of the origin (a quarter of a pixel of error at worst); farther out, neighbouring
+ * pixels start to share a sample. Chunk keys hold 32 bits per axis, far beyond that.
+ *
+ * setView() tells the streamer which part of the world is on screen. Missing visible chunks
+ * are queued first, closest to the view center first, followed by a ring of neighbours, and
+ * background threads render them. compose() then copies whatever is ready into the frame, so
+ * panning never waits for a chunk: the viewer shows the previous pixels for a frame or two
+ * instead of stalling.
+ *
+ * Works with PerlinNoise, SimplexNoise and WorleyNoise. Each worker renders with its own copy of the
+ * generator, taken when the streamer is created or restart() is called.
+ */
+template <typename Generator>
+class ChunkStreamer {
+public:
+    /**
+     * @brief Starts the streamer and its worker threads.
+     *
+     * @param gen Generator to copy. Its width must be at least `chunk`. Its size sets the
+     * scale of the world (the noise spans `scale` cells every `width` pixels), not its extent.
+     * @param chunk Side of the chunks in pixels (default value: 128).
+     * @param memoryCap Largest size of the cache in bytes (default value: 64 MiB).
+     * @param threads Number of worker threads, 0 for one per core but the calling thread (at
+     * least one). Default: 0.
+     */
+    ChunkStreamer(const Generator& gen, unsigned int chunk = 128, std::size_t memoryCap = 64u << 20, unsigned int threads = 0)
+        : chunkSize(chunk), capacity(std::max<std::size_t>(1, memoryCap / (static_cast<std::size_t>(chunk) * chunk * 4))),
+          prototype(std::make_shared<const Generator>(gen)), generation(0), stopping(false), localGeneration(0)
+    {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+            threads = std::max(threads, 1u);
+        }
+        for (unsigned int t = 0; t < threads; ++t) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ChunkStreamer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) {
+            t.join();
+        }
+    }
+
+    /**
+     * @brief Largest world coordinate, in pixels from the origin, at which the float sampling of
+     * the generators stays accurate to a fraction of a pixel.
+     */
+    static constexpr long long kMaxCoordinate = 1ll << 22;
+
+    ChunkStreamer(const ChunkStreamer&) = delete;
+    ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+    /**
+     * @brief Pixels of one chunk: `chunkSize * chunkSize` RGBA values, row by row.
+     */
+    using Chunk = std::shared_ptr<const std::vector<unsigned char>>;
+
+    /**
+     * @brief Replaces the generator and discards every chunk. Call it after any change of the
+     * generator parameters.
+     *
+     * Chunks already being rendered finish in the background and are dropped.
+     *
+     * @param gen Generator to copy, with the same requirements as in the constructor.
+     */
+    void restart(const Generator& gen) {
+        std::lock_guard<std::mutex> lock(mutex);
+        prototype = std::make_shared<const Generator>(gen);
+        generation++;
+        cache.clear();
+        order.clear();
+        pending.clear();
+    }
+
+    /**
+     * @brief Sets the part of the world on screen and schedules its chunks.
+     *
+     * The queue is rebuilt: chunks that are no longer near the view are dropped from it before
+     * they are rendered. Prefetching stops when the visible chunks and the ring would no
+     * longer fit in the cache together.
+     *
+     * @param x World X-coordinate of the top-left pixel of the view.
+     * @param y World Y-coordinate of the top-left pixel of the view.
+     * @param w Width of the view in pixels.
+     * @param h Height of the view in pixels.
+     * @param margin Rings of neighbouring chunks to prefetch around the view (default value: 1).
+     */
+    void setView(long long x, long long y, unsigned int w, unsigned int h, unsigned int margin = 1) {
+        const long long cx0 = floorDiv(x), cy0 = floorDiv(y);
+        const long long cx1 = floorDiv(x + w - 1), cy1 = floorDiv(y + h - 1);
+        const double centerX = (cx0 + cx1) * 0.5, centerY = (cy0 + cy1) * 0.5;
+
+        // Visible chunks first, then the rings, each set closest to the view center first
+        std::vector<std::pair<double, Key>> wanted;
+        for (long long cy = cy0 - margin; cy <= cy1 + static_cast<long long>(margin); ++cy) {
+            for (long long cx = cx0 - margin; cx <= cx1 + static_cast<long long>(margin); ++cx) {
+                const bool visible = cx >= cx0 && cx <= cx1 && cy >= cy0 && cy <= cy1;
+                const double d = (cx - centerX) * (cx - centerX) + (cy - centerY) * (cy - centerY);
+                wanted.push_back({ visible ? d : d + 1e12, key(cx, cy) });
+            }
+        }
+        std::sort(wanted.begin(), wanted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        wanted.resize(std::min(wanted.size(), capacity));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.clear();
+        for (const auto& w : wanted) {
+            auto it = cache.find(w.second);
+            if (it != cache.end()) {
+                touch(it->second);
+            } else if (!rendering.count(w.second)) {
+                pending.push_back(w.second);
+            }
+        }
+        wake.notify_all();
+    }
+
+    /**
+     * @brief Gets a chunk if it is cached, without waiting.
+     *
+     * @return Chunk The pixels, or null when the chunk is not ready. The pixels stay valid
+     * while the pointer is held, even if the chunk is evicted.
+     */
+    Chunk tryChunk(long long cx, long long cy) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(key(cx, cy));
+        if (it == cache.end()) return nullptr;
+        touch(it->second);
+        return it->second.pixels;
+    }
+
+    /**
+     * @brief Gets a chunk, rendering it on the calling thread if needed.
+     *
+     * If a worker is already rendering the chunk, waits for it instead. Meant for the thread
+     * that drives the streamer (the viewer), like every other call.
+     */
+    Chunk chunk(long long cx, long long cy) {
+        const Key k = key(cx, cy);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return !rendering.count(k); });
+        auto it = cache.find(k);
+        if (it != cache.end()) {
+            touch(it->second);
+            return it->second.pixels;
+        }
+        const unsigned long long started = generation;
+        if (!local || localGeneration != generation) {
+            local = std::make_unique<Generator>(*prototype);
+            localGeneration = generation;
+        }
+        rendering.insert(k);
+        lock.unlock();
+        Chunk pixels = render(*local, cx, cy);
+        lock.lock();
+        rendering.erase(k);
+        if (generation == started) store(k, pixels);
+        done.notify_all();
+        return pixels;
+    }
+
+    /**
+     * @brief Copies the ready chunks of a view into an image.
+     *
+     * Pixels of chunks that are not ready are left untouched. Call setView() with the same
+     * view first so that the missing chunks are on their way.
+     *
+     * @param image RGBA buffer of `w * h * 4` bytes.
+     * @param x World X-coordinate of the top-left pixel of the view.
+     * @param y World Y-coordinate of the top-left pixel of the view.
+     * @param w Width of the view in pixels.
+     * @param h Height of the view in pixels.
+     * @return bool True if every visible chunk was ready.
+     */
+    bool compose(std::vector<unsigned char>& image, long long x, long long y, unsigned int w, unsigned int h) {
+        bool complete = true;
+        for (long long cy = floorDiv(y); cy <= floorDiv(y + h - 1); ++cy) {
+            for (long long cx = floorDiv(x); cx <= floorDiv(x + w - 1); ++cx) {
+                const Chunk pixels = tryChunk(cx, cy);
+                if (!pixels) {
+                    complete = false;
+                    continue;
+                }
+                // Overlap of the chunk and the view, in world pixels
+                const long long left = std::max(x, cx * chunkSize);
+                const long long right = std::min(x + w, (cx + 1) * chunkSize);
+                const long long top = std::max(y, cy * chunkSize);
+                const long long bottom = std::min(y + h, (cy + 1) * chunkSize);
+                for (long long wy = top; wy < bottom; ++wy) {
+                    std::memcpy(&image[((wy - y) * w + (left - x)) * 4],
+                        &(*pixels)[((wy - cy * chunkSize) * chunkSize + (left - cx * chunkSize)) * 4],
+                        static_cast<std::size_t>(right - left) * 4);
+                }
+            }
+        }
+        return complete;
+    }
+
+    /**
+     * @brief Gets the side of the chunks in pixels.
+     */
+    unsigned int size() const { return chunkSize; }
+    /**
+     * @brief Gets the number of cached chunks.
+     */
+    std::size_t cached() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cache.size();
+    }
+
+private:
+    using Key = std::uint64_t;
+
+    struct Entry {
+        Chunk pixels;
+        std::list<Key>::iterator position; ///< Place in the recency list.
+    };
+
+    unsigned int chunkSize;
+    std::size_t capacity; ///< Chunks that fit under the memory cap.
+    std::shared_ptr<const Generator> prototype;
+    unsigned long long generation; ///< Incremented by restart(); older renders are dropped.
+    bool stopping;
+    std::unique_ptr<Generator> local; ///< Copy used by chunk() on the calling thread.
+    unsigned long long localGeneration;
+
+    std::mutex mutex;
+    std::condition_variable wake; ///< Signals the workers that the queue changed.
+    std::condition_variable done; ///< Signals that a chunk finished rendering.
+    std::unordered_map<Key, Entry> cache;
+    std::list<Key> order;                ///< Cached chunks, most recently used first.
+    std::deque<Key> pending;             ///< Chunks waiting for a worker, most urgent first.
+    std::unordered_set<Key> rendering;   ///< Chunks being rendered right now.
+    std::vector<std::thread> workers;
+
+    // Chunk coordinates are packed as two 32-bit halves, exact for any chunk within kMaxCoordinate
+    static Key key(long long cx, long long cy) {
+        return (static_cast<Key>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cy);
+    }
+    static long long keyX(Key k) { return static_cast<std::int32_t>(k >> 32); }
+    static long long keyY(Key k) { return static_cast<std::int32_t>(k & 0xffffffffu); }
+
+    // Chunk that contains a world coordinate, rounding toward negative infinity
+    long long floorDiv(long long v) const {
+        const long long c = static_cast<long long>(chunkSize);
+        return v >= 0 ? v / c : -((-v + c - 1) / c);
+    }
+
+    void touch(Entry& e) {
+        order.splice(order.begin(), order, e.position);
+    }
+
+    // Caller holds the lock
+    void store(Key k, const Chunk& pixels) {
+        auto it = cache.find(k);
+        if (it != cache.end()) {
+            it->second.pixels = pixels;
+            touch(it->second);
+            return;
+        }
+        order.push_front(k);
+        cache[k] = { pixels, order.begin() };
+        while (cache.size() > capacity) {
+            cache.erase(order.back());
+            order.pop_back();
+        }
+    }
+
+    Chunk render(Generator& gen, long long cx, long long cy) const {
+        // The generator writes at its own image stride, so the chunk is rendered into the
+        // top-left corner of a scratch image and copied out row by row
+        static thread_local std::vector<unsigned char> scratch;
+        const unsigned int stride = static_cast<unsigned int>(gen.getWidth());
+        scratch.resize(static_cast<std::size_t>(stride) * chunkSize * 4);
+        gen.setOrigin(static_cast<double>(cx) * chunkSize, static_cast<double>(cy) * chunkSize);
+        gen.renderRegion(scratch, 0, 0, chunkSize, chunkSize);
+        auto pixels = std::make_shared<std::vector<unsigned char>>(static_cast<std::size_t>(chunkSize) * chunkSize * 4);
+        for (unsigned int row = 0; row < chunkSize; ++row) {
+            std::memcpy(&(*pixels)[static_cast<std::size_t>(row) * chunkSize * 4],
+                &scratch[static_cast<std::size_t>(row) * stride * 4], chunkSize * 4);
+        }
+        return pixels;
+    }
+
+    void work() {
+        std::unique_ptr<Generator> gen;
+        unsigned long long current = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || !pending.empty(); });
+            if (stopping) return;
+            const Key k = pending.front();
+            pending.pop_front();
+            if (cache.count(k) || rendering.count(k)) continue;
+            rendering.insert(k);
+            if (!gen || current != generation) {
+                gen = std::make_unique<Generator>(*prototype);
+                current = generation;
+            }
+            lock.unlock();
+            Chunk pixels = render(*gen, keyX(k), keyY(k));
+            lock.lock();
+            rendering.erase(k);
+            if (current == generation) store(k, pixels);
+            done.notify_all();
+        }
+    }
+};
+
+#endif
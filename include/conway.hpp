@@ -2,6 +2,33 @@
 #define __CONWAY_HPP__ 1
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Rectangle of the grid that changed, with its pixels in GameOfLife::regionPixels().
+ */
+struct LifeRegion {
+    unsigned int x, y;          ///< Top-left cell.
+    unsigned int width, height; ///< Size in cells.
+    std::size_t offset;         ///< First byte of its `width * height` RGBA pixels, row by row.
+};
+
+/**
+ * @brief Scratch of one chunk of rows of GameOfLife::nextGeneration(), kept between generations.
+ */
+struct LifeStepScratch {
+    /**
+     * @brief Bit-sliced neighbour counts of words [first, last) of one row (see conway.cpp).
+     */
+    struct RowSums {
+        long long row = -1;
+        unsigned int first = 0, last = 0;
+        std::vector<std::uint64_t> pad, s, c, t0, t1;
+    };
+    RowSums slots[3];                          ///< Sums of the rows above, at and below the current one.
+    std::vector<std::uint64_t> flips, changes; ///< Bits changed in each word over a row of tiles.
+};
 
 /**
  * @class GameOfLife
@@ -9,9 +36,27 @@
  *
  * This class models the Game of Life on a 2D grid, supporting state evolution
  * and generating visual output as an image.
+ *
+ * Cells are stored one bit each, 64 to a word, and a generation is computed a word at a time:
+ * the neighbours of 64 cells are added with bitwise full adders (bit-sliced counters) instead of
+ * being counted one by one, and AVX2 and AVX-512 builds process four words per instruction.
+ * The grid wraps around at the edges (a torus) for any width, and rows are split across threads.
+ *
+ * Both generations live in flat buffers that swap after each step, and the grid is divided into
+ * tiles of 64 x `kTileHeight` cells that remember whether they changed. updateRegions() redraws
+ * only those tiles, so a viewer uploads a few rectangles per frame instead of the whole grid.
+ * The scratch of each chunk of rows is kept between generations, so once the first frame is
+ * drawn only grids large enough to split across threads allocate, when parallelFor() starts
+ * the threads of each generation.
+ *
+ * A tile is only computed when it or one of its neighbours differs from two generations ago;
+ * otherwise it just repeats the previous generation, which the other buffer still holds. Still
+ * lifes and blinkers, most of what a soup settles into, therefore cost nothing per generation.
  */
 class GameOfLife {
 public:
+    static constexpr unsigned int kTileHeight = 16; ///< Height of the tiles that track changes, in cells (they are one word wide).
+
     /**
      * @brief Constructs a GameOfLife instance with a given grid size.
      *
@@ -40,22 +85,85 @@ public:
      * @return std::vector<unsigned char> A vector containing the image in RGBA format.
      */
     std::vector<unsigned char> generateImage();
+    /**
+     * @brief Redraws the parts of the grid that changed since the previous call.
+     *
+     * Changed tiles are merged into rectangles along each row of tiles, and their pixels (in
+     * the format of generateImage()) are packed one after another in regionPixels(). The first
+     * call returns the whole grid. A viewer uploads each rectangle with
+     * `texture.update(game.regionPixels().data() + r.offset, r.width, r.height, r.x, r.y)`.
+     *
+     * @return const std::vector<LifeRegion>& The rectangles, valid until the next call.
+     */
+    const std::vector<LifeRegion>& updateRegions();
+    /**
+     * @brief Gets the pixels of the rectangles returned by updateRegions().
+     *
+     * @return const std::vector<unsigned char>& RGBA pixels, indexed by LifeRegion::offset.
+     */
+    const std::vector<unsigned char>& regionPixels() const { return regionBuffer; }
 
-private:
-    unsigned int width; /**< Width of the grid. */
-    unsigned int height; /**< Height of the grid. */
-    std::vector<std::vector<int>> grid; /**< 2D grid representing cell states (0 = dead, 1 = alive). */
     /**
-     * @brief Counts the number of alive neighbors for a given cell.
+     * @brief Gets the state of a cell.
      *
-     * Uses toroidal wrapping to handle edges, allowing neighbors to wrap around
-     * to the opposite side of the grid.
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @return bool True if the cell is alive.
+     */
+    bool isAlive(unsigned int x, unsigned int y) const {
+        return (cells[static_cast<std::size_t>(y) * words + (x >> 6)] >> (x & 63)) & 1;
+    }
+    /**
+     * @brief Sets the state of a cell.
      *
      * @param x X-coordinate of the cell.
      * @param y Y-coordinate of the cell.
-     * @return int Number of alive neighbors.
+     * @param alive New state.
+     */
+    void setCell(unsigned int x, unsigned int y, bool alive);
+    /**
+     * @brief Kills every cell.
+     */
+    void clear();
+    /**
+     * @brief Counts the live cells.
+     *
+     * @return std::size_t Number of live cells.
+     */
+    std::size_t population() const;
+    /**
+     * @brief Gets the width of the grid.
+     *
+     * @return unsigned int Width in cells.
+     */
+    unsigned int getWidth() const { return width; }
+    /**
+     * @brief Gets the height of the grid.
+     *
+     * @return unsigned int Height in cells.
+     */
+    unsigned int getHeight() const { return height; }
+
+private:
+    unsigned int width; /**< Width of the grid. */
+    unsigned int height; /**< Height of the grid. */
+    unsigned int words; /**< 64-bit words per row; the unused bits of the last one stay 0. */
+    std::vector<std::uint64_t> cells; /**< Current generation: cell `x` of a row is bit `x % 64` of its word `x / 64`. */
+    std::vector<std::uint64_t> next; /**< Generation being computed, swapped with `cells` when done. */
+    unsigned int tileRows; /**< Rows of tiles; a tile is one word wide. */
+    std::vector<unsigned char> stale; /**< Tiles changed since the last updateRegions(), `words` per row of tiles. */
+    std::vector<unsigned char> changed; /**< Tiles that differ from two generations ago, or were edited. */
+    std::vector<unsigned char> flipped; /**< Tiles that differ from the previous generation. */
+    std::vector<unsigned char> active; /**< Tiles computed in the current step. */
+    std::vector<LifeRegion> regions; /**< Rectangles of the last updateRegions(). */
+    std::vector<unsigned char> regionBuffer; /**< Their pixels. */
+    std::vector<LifeStepScratch> scratch; /**< Scratch of each chunk of rows of a generation. */
+
+    /**
+     * @brief Computes the next generation of the active tiles in rows of tiles [first, last) into
+     * `next`, and updates the flags of every tile in them, using the scratch of their chunk.
      */
-    int countNeighbors(int x, int y);
+    void stepTiles(unsigned int first, unsigned int last, LifeStepScratch& scratch);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,141 @@
+#ifndef __EXPLORER_HPP__
+#define __EXPLORER_HPP__ 1
+
+#include <vector>
+
+/**
+ * @brief A zoom target found by the FractalExplorer.
+ *
+ * The fields map directly to the setters of Mandelbrot and JuliaSet
+ * (`setMoveX`, `setMoveY`, `setZoom`, `setMaxIterations`).
+ */
+struct ExplorerTarget {
+    float moveX;       ///< Horizontal offset of the view center.
+    float moveY;       ///< Vertical offset of the view center.
+    float zoom;        ///< Zoom factor (pixels per unit of the complex plane).
+    int maxIterations; ///< Iteration limit recommended for this depth.
+    float score;       ///< Visual richness of the view (higher is better).
+};
+
+/**
+ * @class FractalExplorer
+ * @brief Finds visually rich zoom targets in the Mandelbrot and Julia sets.
+ *
+ * The explorer renders cheap low-resolution probes of the current view, splits each probe into
+ * tiles and scores every tile by the entropy of its iteration counts and by its boundary density
+ * (how often neighbouring samples disagree about escaping). It then descends into the best tile
+ * and repeats. Several descents, each starting from a different top-level tile, produce a ranked
+ * list of targets.
+ *
+ * The probe resolution is derived from the final render size: all the probes of a call to
+ * explore() evaluate at most 1% of the samples of a `width x height` render, with the same
+ * iteration limits, so they cost under 1% of the final image. Small renders get fewer levels
+ * rather than bigger probes.
+ */
+class FractalExplorer {
+public:
+    /**
+     * @brief Constructs an explorer for the Mandelbrot set.
+     *
+     * @param w Width of the final render (sets the aspect ratio and the probe budget).
+     * @param h Height of the final render.
+     * @param zoom Zoom of the starting view (default value: 200.0).
+     * @param moveX Horizontal offset of the starting view (default value: -0.5).
+     * @param moveY Vertical offset of the starting view (default value: 0.0).
+     * @param maxIterations Iteration limit of the starting view (default value: 100).
+     */
+    FractalExplorer(unsigned int w, unsigned int h, float zoom = 200.0f, float moveX = -0.5f,
+        float moveY = 0.0f, int maxIterations = 100);
+
+    /**
+     * @brief Finds zoom targets starting from the current view.
+     *
+     * @param count Number of targets to return (default value: 5).
+     * @return std::vector<ExplorerTarget> Targets sorted by decreasing score.
+     */
+    std::vector<ExplorerTarget> explore(int count = 5);
+
+    /**
+     * @brief Explores the Julia set for the constant `c` instead of the Mandelbrot set.
+     *
+     * @param c_real Real part of the complex constant `c`.
+     * @param c_imag Imaginary part of the complex constant `c`.
+     */
+    void setJulia(float c_real, float c_imag);
+    /**
+     * @brief Explores the Mandelbrot set (the default).
+     */
+    void setMandelbrot();
+    /**
+     * @brief Sets the starting view.
+     *
+     * @param zoom Zoom factor.
+     * @param moveX Horizontal offset.
+     * @param moveY Vertical offset.
+     */
+    void setStart(float zoom, float moveX, float moveY);
+    /**
+     * @brief Sets how many levels each descent goes down.
+     *
+     * @param levels Number of levels. Each level zooms in by the tile factor (4x). Default: 6.
+     *
+     * The descent also stops earlier when the view gets too small for the float precision
+     * used by the generators.
+     */
+    void setDepth(int levels);
+    /**
+     * @brief Snaps Mandelbrot targets to the nucleus of the nearest minibrot.
+     *
+     * @param enabled When true, Newton's method locates the center of the minibrot whose
+     * period is detected from the orbit of the target. Ignored for Julia sets. Default: false.
+     */
+    void setNucleusSearch(bool enabled);
+    /**
+     * @brief Gets the number of probe samples evaluated by the last call to explore().
+     *
+     * @return long long Probe samples, at most 1% of `width * height` (a single minimal probe
+     * for renders smaller than about 160x160).
+     */
+    long long getProbeSamples() { return probeSamples; }
+
+private:
+    unsigned int width, height;
+    float startZoom, startX, startY;
+    int baseIterations;
+    int depth;
+    bool julia;
+    double c_re, c_im;
+    bool nucleusSearch;
+    long long probeSamples;
+
+    /**
+     * @brief Renders a probe of a view and returns the iteration count of every sample.
+     *
+     * @param cx Real part of the view center.
+     * @param cy Imaginary part of the view center.
+     * @param zoom Zoom of the view.
+     * @param gx Samples per row.
+     * @param gy Samples per column.
+     * @param maxIterations Iteration limit.
+     * @return std::vector<int> `gx * gy` iteration counts, row-major.
+     */
+    std::vector<int> probe(double cx, double cy, double zoom, int gx, int gy, int maxIterations);
+    /**
+     * @brief Scores one tile of a probe.
+     *
+     * @return float Iteration-count entropy weighted by boundary density.
+     */
+    float scoreTile(const std::vector<int>& counts, int gx, int x0, int y0, int tw, int th, int maxIterations);
+    /**
+     * @brief Refines a Mandelbrot point to the nucleus of the minibrot it belongs to.
+     *
+     * @param cx Real part, updated in place when a nucleus is found.
+     * @param cy Imaginary part, updated in place when a nucleus is found.
+     * @param maxIterations Orbit length used for period detection.
+     * @param radius Maximum distance the nucleus may lie from the starting point.
+     * @return bool True when a nucleus was found.
+     */
+    bool findNucleus(double& cx, double& cy, int maxIterations, double radius);
+};
+
+#endif
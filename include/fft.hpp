@@ -0,0 +1,93 @@
+#ifndef __FFT_HPP__
+#define __FFT_HPP__ 1
+
+#include <vector>
+#include <complex>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @class FFT
+ * @brief Discrete Fourier transform of a fixed length, for any length.
+ *
+ * Lengths whose prime factors are all small are transformed with a mixed-radix Cooley-Tukey
+ * algorithm (radix 4 and 2 butterflies, a generic butterfly for the other factors). Lengths with
+ * a large prime factor use Bluestein's algorithm: the transform becomes a convolution computed
+ * with a power-of-two FFT. Either way the cost is O(n log n).
+ *
+ * The object only holds precomputed tables: transforms are const and the caller provides the
+ * scratch buffer, so one FFT can be shared by several threads.
+ */
+class FFT {
+public:
+    /**
+     * @brief Precomputes the twiddle factors for transforms of length `n`.
+     *
+     * @param n Length of the transform (at least 1).
+     */
+    explicit FFT(unsigned int n);
+
+    /**
+     * @brief Gets the length of the transform.
+     */
+    unsigned int size() const { return n; }
+    /**
+     * @brief Gets the number of complex values of scratch that a transform needs.
+     */
+    std::size_t workSize() const;
+
+    /**
+     * @brief Forward transform in place: `X[k] = sum_j x[j] exp(-2 pi i jk / n)`.
+     *
+     * @param data `n` complex values.
+     * @param work Scratch of workSize() complex values.
+     */
+    void forward(std::complex<float>* data, std::complex<float>* work) const;
+    /**
+     * @brief Inverse transform in place, without the `1 / n` normalization.
+     *
+     * @param data `n` complex values.
+     * @param work Scratch of workSize() complex values.
+     */
+    void inverse(std::complex<float>* data, std::complex<float>* work) const;
+
+private:
+    unsigned int n;
+    std::vector<int> radices;                   ///< Factors of `n`, in the order of the recursion (empty with Bluestein).
+    std::vector<std::complex<float>> twiddles;  ///< exp(-2 pi i k / n).
+
+    // Bluestein
+    std::shared_ptr<const FFT> convolution;         ///< Power-of-two transform of the convolution.
+    std::vector<std::complex<float>> chirp;         ///< exp(-pi i k^2 / n).
+    std::vector<std::complex<float>> chirpSpectrum; ///< Transform of the conjugated chirp, scaled by 1 / m.
+
+    /**
+     * @brief Recursive mixed-radix step: transforms `length` values read from `in` with stride
+     * `stride` into `out`.
+     */
+    void mixedRadix(std::complex<float>* out, const std::complex<float>* in, std::size_t stride,
+        std::size_t factor, unsigned int length) const;
+    /**
+     * @brief Bluestein transform of `data`.
+     */
+    void bluestein(std::complex<float>* data, std::complex<float>* work) const;
+};
+
+/**
+ * @brief Inverse 2D transform of a Hermitian spectrum into a real field.
+ *
+ * Only the half spectrum is stored: `height` rows of `width / 2 + 1` bins, bin `(kx, ky)` at
+ * `ky * (width / 2 + 1) + kx`. The columns are transformed first, then every row goes through a
+ * real inverse transform; even widths pack the row into a complex transform of half the length.
+ * Columns and rows are split across threads. The spectrum must be Hermitian along the `kx = 0`
+ * column (and `kx = width / 2` for even widths); its contents are destroyed.
+ *
+ * @param spectrum Half spectrum, `height * (width / 2 + 1)` values.
+ * @param width Width of the field.
+ * @param height Height of the field.
+ * @param out Receives `width * height` values, row by row, without the `1 / (width * height)`
+ * normalization.
+ */
+void inverseRealFFT2D(std::vector<std::complex<float>>& spectrum, unsigned int width, unsigned int height, float* out);
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef __FOVEATED_HPP__
+#define __FOVEATED_HPP__ 1
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+/**
+ * @class FoveatedRenderer
+ * @brief Progressive renderer that spends the frame budget where the user is looking.
+ *
+ * The image is split into square tiles. After a view change, the tiles inside the fovea (a circle
+ * around the cursor or the view center) are rendered at full sample density and iteration limit,
+ * while the periphery gets a cheap preview with coarse samples and a reduced iteration limit.
+ * Peripheral tiles are then upgraded over the following frames, closest to the fovea first,
+ * until the whole image reaches full quality.
+ *
+ * Works with any generator that provides
+ * `renderRegion(image, x0, y0, x1, y1, step, detail)`: Mandelbrot, JuliaSet, Newton,
+ * PerlinNoise and SimplexNoise.
+ */
+template <typename Generator>
+class FoveatedRenderer {
+public:
+    /**
+     * @brief Constructs a foveated renderer for a generator.
+     *
+     * @param gen Generator that renders the regions. It must outlive the renderer.
+     * @param w Width of the image (must match the generator).
+     * @param h Height of the image (must match the generator).
+     * @param tile Side of the square tiles in pixels (default value: 64). Multiples of 4 keep the
+     * coarse samples aligned to the tile grid.
+     */
+    FoveatedRenderer(Generator& gen, unsigned int w, unsigned int h, unsigned int tile = 64)
+        : generator(gen), width(w), height(h), tileSize(tile) {
+        image.resize(width * height * 4, 0);
+        tilesX = (width + tileSize - 1) / tileSize;
+        tilesY = (height + tileSize - 1) / tileSize;
+        levels.resize(tilesX * tilesY, -1);
+        foveaX = width / 2;
+        foveaY = height / 2;
+        foveaRadius = std::min(width, height) / 4;
+    }
+
+    /**
+     * @brief Moves the fovea.
+     *
+     * Tiles that enter the fovea are brought to full quality on the next update(); nothing that
+     * was already rendered is discarded.
+     *
+     * @param x X-coordinate of the fovea center (usually the cursor).
+     * @param y Y-coordinate of the fovea center.
+     * @param radius Radius of the full-quality region in pixels.
+     */
+    void setFovea(unsigned int x, unsigned int y, unsigned int radius) {
+        foveaX = x;
+        foveaY = y;
+        foveaRadius = radius;
+    }
+
+    /**
+     * @brief Invalidates every tile. Call it after any change of the generator parameters.
+     */
+    void restart() {
+        std::fill(levels.begin(), levels.end(), -1);
+    }
+
+    /**
+     * @brief Renders tiles for one frame.
+     *
+     * The fovea at full quality and a preview of the periphery are always rendered, so the
+     * displayed image never shows stale content. The remaining time up to `budgetMs` is spent
+     * upgrading peripheral tiles.
+     *
+     * @param budgetMs Time budget for the frame in milliseconds.
+     * @return bool True if any pixel changed and the texture must be updated.
+     */
+    bool update(float budgetMs) {
+        const auto start = std::chrono::steady_clock::now();
+        bool changed = false;
+
+        // Fovea a calidad completa y vista previa de la periferia
+        for (unsigned int t = 0; t < levels.size(); ++t) {
+            const int target = inFovea(t) ? kFullLevel : 0;
+            if (levels[t] < target) {
+                renderTile(t, target);
+                changed = true;
+            }
+        }
+
+        // Mejora progresiva de la periferia, primero lo más cercano a la fovea
+        while (true) {
+            const float elapsed = std::chrono::duration<float, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            if (elapsed >= budgetMs) break;
+
+            const int t = nextTile();
+            if (t < 0) break;
+            renderTile(t, levels[t] + 1);
+            changed = true;
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Renders every remaining tile at full quality, ignoring the time budget.
+     */
+    void finish() {
+        for (unsigned int t = 0; t < levels.size(); ++t) {
+            if (levels[t] < kFullLevel) renderTile(t, kFullLevel);
+        }
+    }
+
+    /**
+     * @brief Checks whether the whole image is at full quality.
+     *
+     * @return bool True when no tile is pending an upgrade.
+     */
+    bool finished() const {
+        return std::all_of(levels.begin(), levels.end(), [](int l) { return l == kFullLevel; });
+    }
+
+    /**
+     * @brief Gets the current image.
+     *
+     * @return const std::vector<unsigned char>& The RGBA pixels, `width * height * 4` bytes.
+     */
+    const std::vector<unsigned char>& pixels() const { return image; }
+
+private:
+    // Niveles de calidad: separación entre muestras y fracción del límite de iteraciones
+    static constexpr int kFullLevel = 2;
+    static constexpr unsigned int kSteps[kFullLevel + 1] = { 4, 2, 1 };
+    static constexpr float kDetail[kFullLevel + 1] = { 0.25f, 0.5f, 1.0f };
+
+    Generator& generator;
+    unsigned int width, height;
+    unsigned int tileSize;
+    unsigned int tilesX, tilesY;
+    std::vector<unsigned char> image;
+    std::vector<int> levels; ///< Quality level of each tile (-1 = stale).
+    unsigned int foveaX, foveaY, foveaRadius;
+
+    void renderTile(unsigned int t, int level) {
+        const unsigned int x0 = (t % tilesX) * tileSize;
+        const unsigned int y0 = (t / tilesX) * tileSize;
+        const unsigned int x1 = std::min(x0 + tileSize, width);
+        const unsigned int y1 = std::min(y0 + tileSize, height);
+        generator.renderRegion(image, x0, y0, x1, y1, kSteps[level], kDetail[level]);
+        levels[t] = level;
+    }
+
+    // Distancia al cuadrado desde el centro de la fovea al punto más cercano del tile
+    float distance2(unsigned int t) const {
+        const float x0 = static_cast<float>((t % tilesX) * tileSize);
+        const float y0 = static_cast<float>((t / tilesX) * tileSize);
+        const float dx = std::max({ x0 - foveaX, 0.0f, foveaX - (x0 + tileSize) });
+        const float dy = std::max({ y0 - foveaY, 0.0f, foveaY - (y0 + tileSize) });
+        return dx * dx + dy * dy;
+    }
+
+    bool inFovea(unsigned int t) const {
+        return distance2(t) <= static_cast<float>(foveaRadius) * foveaRadius;
+    }
+
+    // Tile pendiente con el nivel más bajo; a igual nivel, el más cercano a la fovea
+    int nextTile() const {
+        int best = -1;
+        float bestDistance = 0.0f;
+        for (unsigned int t = 0; t < levels.size(); ++t) {
+            if (levels[t] >= kFullLevel) continue;
+            const float d = distance2(t);
+            if (best < 0 || levels[t] < levels[best] || (levels[t] == levels[best] && d < bestDistance)) {
+                best = static_cast<int>(t);
+                bestDistance = d;
+            }
+        }
+        return best;
+    }
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef __HASHLIFE_HPP__
+#define __HASHLIFE_HPP__ 1
+
+#include "conway.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class HashLife
+ * @brief Runs the Game of Life with Gosper's HashLife algorithm on an unbounded plane.
+ *
+ * The plane is a quadtree whose identical subtrees are stored once (hash consing): every node is
+ * looked up in a hash table by its four children before it is created, and the leaves are 8x8
+ * blocks of cells packed in one word. Each node of side `2^k` remembers its center of side
+ * `2^(k-1)` after `2^(k-2)` generations (or fewer, see advance()), computed from the results of
+ * its subnodes. Repeated and empty regions are therefore computed once, and regular patterns
+ * jump ahead an exponential number of generations in the time GameOfLife needs for one.
+ *
+ * Unlike GameOfLife, the plane does not wrap around: load() and store() copy a window between
+ * both, so they agree while the pattern stays away from the edges of the torus. The nodes are
+ * collected when their memory passes the cap given to the constructor; memoized results are kept
+ * if the live nodes still fit in half of it, and dropped otherwise.
+ */
+class HashLife {
+public:
+    /**
+     * @brief Creates an empty plane.
+     *
+     * @param memoryCap Memory for the nodes, in bytes, above which they are collected before the
+     * next step (default value: 256 MiB). A single step may go over it.
+     */
+    explicit HashLife(std::size_t memoryCap = std::size_t(256) << 20);
+
+    /**
+     * @brief Replaces the plane with the cells of a GameOfLife grid.
+     *
+     * @param game Grid to copy; its cell (0, 0) lands on cell (0, 0) of the plane.
+     */
+    void load(const GameOfLife& game);
+    /**
+     * @brief Copies a window of the plane into a GameOfLife grid, replacing all its cells.
+     *
+     * @param game Grid that receives the window, which has the size of the grid.
+     * @param x0 X-coordinate of the window's top-left cell on the plane.
+     * @param y0 Y-coordinate of the window's top-left cell on the plane.
+     */
+    void store(GameOfLife& game, long long x0 = 0, long long y0 = 0) const;
+
+    /**
+     * @brief Gets the state of a cell.
+     *
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @return bool True if the cell is alive.
+     */
+    bool isAlive(long long x, long long y) const;
+    /**
+     * @brief Sets the state of a cell.
+     *
+     * @param x X-coordinate of the cell.
+     * @param y Y-coordinate of the cell.
+     * @param alive New state.
+     */
+    void setCell(long long x, long long y, bool alive);
+
+    /**
+     * @brief Advances the plane a number of generations.
+     *
+     * The count is covered one power of two at a time, from the largest: `1 << 40` is a single
+     * step. Changing the power between calls clears the memoized results, so repeated calls
+     * should use the same count.
+     *
+     * @param generations Number of generations.
+     * @return bool False if the pattern would outgrow 64-bit coordinates; the plane then keeps
+     * the generations reached so far.
+     */
+    bool advance(std::uint64_t generations);
+    /**
+     * @brief Gets the number of generations advanced since the last load().
+     */
+    std::uint64_t getGeneration() const { return generation; }
+    /**
+     * @brief Counts the live cells (saturated at the largest 64-bit value).
+     */
+    std::uint64_t population() const { return nodes[root].population; }
+    /**
+     * @brief Gets the memory held by the nodes and the hash table, in bytes.
+     */
+    std::size_t memoryUsage() const;
+    /**
+     * @brief Frees the nodes that are no longer part of the plane.
+     *
+     * @param keepResults Keep the memoized results (and the nodes they point to) of the live nodes.
+     */
+    void collectGarbage(bool keepResults = true);
+
+private:
+    /**
+     * @brief Quadtree node. Leaves (level 3) hold 8x8 cells, bit `x + 8 * y` of `bits`.
+     */
+    struct Node {
+        std::uint64_t bits = 0;          ///< Cells of a leaf.
+        std::uint64_t population = 0;   ///< Live cells.
+        std::uint32_t nw = 0, ne = 0, sw = 0, se = 0; ///< Children (inner nodes).
+        std::uint32_t result = 0;        ///< Memoized center after the current step, 0 if unknown.
+        std::uint32_t next = 0;          ///< Next node in the same hash bucket.
+        std::uint8_t level = 0;          ///< Side of `2^level` cells.
+        bool marked = false;             ///< Reached during garbage collection.
+    };
+
+    std::vector<Node> nodes;              ///< Node 0 is unused, so that 0 means "none".
+    std::vector<std::uint32_t> buckets;   ///< Hash table: first node of each bucket.
+    std::vector<std::uint32_t> emptyNodes; ///< Empty node of each level, created on demand.
+    std::uint32_t root;
+    unsigned int stepLog;                 ///< Results advance `2^stepLog` generations at most.
+    std::uint64_t generation;
+    std::size_t memoryCap;
+
+    std::uint32_t leaf(std::uint64_t bits);
+    std::uint32_t join(std::uint32_t nw, std::uint32_t ne, std::uint32_t sw, std::uint32_t se);
+    std::uint32_t empty(unsigned int level);
+    std::uint32_t center(std::uint32_t n);
+    std::uint32_t result(std::uint32_t n);
+    std::uint32_t baseResult(std::uint32_t n);
+    std::uint32_t setRec(std::uint32_t n, std::uint64_t x, std::uint64_t y, bool alive);
+    void storeRec(std::uint32_t n, long long x, long long y, GameOfLife& game, long long x0, long long y0) const;
+    /**
+     * @brief Doubles the side of the root around its center.
+     */
+    void expand();
+    /**
+     * @brief Tells whether the pattern lies inside the central half of the root.
+     */
+    bool centered() const;
+    void rehash(std::size_t size);
+    void clearResults();
+    /**
+     * @brief Advances `2^stepLog` generations.
+     */
+    bool step();
+};
+
+#endif
@@ -3,6 +3,12 @@
 #include "perlin.hpp"
 #include "fractal.hpp"
 #include "conway.hpp"
+#include "explorer.hpp"
+#include "kleinian.hpp"
+#include "spectral.hpp"
+#include "bluenoise.hpp"
+#include "worley.hpp"
+#include <cstdint>
 
 /**
  * @brief Generates a unique file name based on the current timestamp.
@@ -22,4 +28,90 @@
  */
 std::string generateUniqueFileName();
 
-#endif
\ No newline at end of file
+/**
+ * @brief Fills a rectangular block of an RGBA image with a single color.
+ *
+ * Used by the generators to splat one sample over a `w x h` block when a region is rendered
+ * at reduced sample density. The block is clipped by the caller.
+ *
+ * @param image RGBA buffer of `width * height * 4` bytes.
+ * @param width Width of the image in pixels.
+ * @param x X-coordinate of the top-left pixel of the block.
+ * @param y Y-coordinate of the top-left pixel of the block.
+ * @param w Width of the block in pixels.
+ * @param h Height of the block in pixels.
+ * @param r Red component.
+ * @param g Green component.
+ * @param b Blue component.
+ * @param a Alpha component.
+ */
+void fillBlock(std::vector<unsigned char>& image, unsigned int width, unsigned int x, unsigned int y,
+    unsigned int w, unsigned int h, unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+
+/**
+ * @brief Downsampling filters for buildMipChain().
+ */
+enum class MipFilter {
+    Box,    ///< Average of each 2x2 block. Fastest; slightly blurry and prone to aliasing.
+    Kaiser  ///< 8-tap Kaiser-windowed sinc, separable. Sharper levels with less aliasing.
+};
+
+/**
+ * @brief Builds the full mip chain of a tileable RGBA image.
+ *
+ * Each level halves the previous one (rounding down, never below 1 pixel) until the 1x1 level.
+ * Filter taps that fall outside the image wrap around to the opposite edge, so the levels of a
+ * seamless tile are seamless as well. The box filter runs eight output pixels per instruction
+ * in AVX2 builds; the Kaiser filter works on float rows that the compiler vectorizes.
+ *
+ * @param image RGBA buffer of `width * height * 4` bytes (level 0).
+ * @param width Width of the image in pixels.
+ * @param height Height of the image in pixels.
+ * @param filter Downsampling filter (default value: MipFilter::Box).
+ * @return std::vector<std::vector<unsigned char>> Level `k` at index `k`, starting with a copy
+ * of the image; level `k` measures `max(1, width >> k) x max(1, height >> k)`.
+ */
+std::vector<std::vector<unsigned char>> buildMipChain(const std::vector<unsigned char>& image,
+    unsigned int width, unsigned int height, MipFilter filter = MipFilter::Box);
+
+/**
+ * @brief Converts a float field to 16-bit samples.
+ *
+ * Values are mapped linearly from `[low, high]` to `[0, 65535]` and clamped, which keeps 256
+ * times the precision of an 8-bit channel for terrain heights.
+ *
+ * @param field Values, such as the output of PerlinNoise::generateField().
+ * @param low Value mapped to 0.
+ * @param high Value mapped to 65535.
+ * @return std::vector<std::uint16_t> One sample per value, in the same order.
+ */
+std::vector<std::uint16_t> quantizeField(const std::vector<float>& field, float low, float high);
+
+/**
+ * @brief Saves 16-bit samples as a single-channel (grayscale) PNG.
+ *
+ * The rows go through the Paeth filter and the zlib encoder of stb_image_write, which only
+ * writes 8-bit PNGs itself.
+ *
+ * @param fileName Path of the PNG file.
+ * @param pixels `width * height` samples, row by row.
+ * @param width Width of the image in pixels.
+ * @param height Height of the image in pixels.
+ * @return bool True if the file was written.
+ */
+bool writePNG16(const std::string& fileName, const std::vector<std::uint16_t>& pixels, unsigned int width, unsigned int height);
+
+/**
+ * @brief Saves a float field as raw 32-bit floats.
+ *
+ * The file has no header: it holds the values row by row in the byte order of the machine
+ * (little-endian on x86), so it can be memory-mapped as a `float` array or imported as raw
+ * 32-bit data by terrain tools. The caller keeps track of the dimensions.
+ *
+ * @param fileName Path of the file.
+ * @param field Values to save.
+ * @return bool True if the file was written.
+ */
+bool writeRawField(const std::string& fileName, const std::vector<float>& field);
+
+#endif
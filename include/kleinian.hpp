@@ -0,0 +1,149 @@
+#ifndef __KLEINIAN_HPP__
+#define __KLEINIAN_HPP__ 1
+
+#include <vector>
+#include <complex>
+#include <string>
+
+/**
+ * @class Kleinian
+ * @brief Draws the limit set of a two-generator Kleinian group of Mobius transformations.
+ *
+ * The generators `a` and `b` are built with "Grandma's recipe" (Mumford, Series and Wright,
+ * Indra's Pearls) from their traces `ta` and `tb`, which makes the commutator `abAB` parabolic
+ * and the limit set a connected curve. The default traces `ta = tb = 2` give the Apollonian gasket.
+ *
+ * Reduced words (no letter followed by its inverse) are enumerated depth first. For each word,
+ * the fixed points of the three special words that bound its branch are mapped through it; once
+ * these image points lie within `epsilon` pixels of each other the branch is drawn as a short
+ * polyline and pruned. The traversal is split across threads by the first two letters.
+ */
+class Kleinian {
+public:
+    /**
+     * @brief Constructor for the Kleinian limit set generator.
+     *
+     * @param w Width of the image.
+     * @param h Height of the image.
+     * @param zoom Zoom factor, in pixels per unit of the complex plane (default value: 150.0).
+     * @param moveX Offset in the X direction (default value: 0.0).
+     * @param moveY Offset in the Y direction (default value: 0.0).
+     */
+    Kleinian(unsigned int w, unsigned int h, float zoom = 150.0f, float moveX = 0.0f, float moveY = 0.0f);
+
+    /**
+     * @brief Generates the limit set image.
+     *
+     * @param imageName File name where the generated image will be saved. The name is generated automatically.
+     *
+     * @return std::vector<unsigned char> A vector representing the generated image in RGBA format.
+     */
+    std::vector<unsigned char> generateImage(std::string& imageName);
+
+    /**
+     * @brief Sets the traces of the generators `a` and `b`.
+     *
+     * @param ta_re Real part of the trace of `a`.
+     * @param ta_im Imaginary part of the trace of `a`.
+     * @param tb_re Real part of the trace of `b`.
+     * @param tb_im Imaginary part of the trace of `b`.
+     *
+     * `ta = tb = 2` gives the Apollonian gasket. Values such as `ta = 1.91 + 0.05i`, `tb = 2`
+     * give spiralling limit sets; traces far from 2 may produce groups that are not discrete.
+     */
+    void setTraces(float ta_re, float ta_im, float tb_re, float tb_im);
+    /**
+     * @brief Sets the pruning threshold.
+     *
+     * @param pixels Distance in pixels below which a branch is drawn and not refined further.
+     * Default: 1.0. Larger values are faster and coarser.
+     */
+    void setEpsilon(float pixels) { epsilon = pixels; }
+    /**
+     * @brief Sets the maximum word length.
+     *
+     * @param depth Words are never longer than `depth` letters (default value: 120). It only
+     * bounds branches that do not shrink, such as the neighbourhood of parabolic points.
+     */
+    void setMaxDepth(int depth) { maxDepth = depth; }
+    /**
+     * @brief Adjusts the zoom factor.
+     *
+     * @param z The new zoom value, in pixels per unit of the complex plane.
+     */
+    void setZoom(float z) { zoom = z; }
+    /**
+     * @brief Adjusts the X offset.
+     *
+     * @param x The new X offset value.
+     */
+    void setMoveX(float x) { moveX = x; }
+    /**
+     * @brief Adjusts the Y offset.
+     *
+     * @param y The new Y offset value.
+     */
+    void setMoveY(float y) { moveY = y; }
+    /**
+     * @brief Adjusts the RGB color saturation in the image.
+     *
+     * @param r Red saturation (value between 0 and 1).
+     * @param g Green saturation (value between 0 and 1).
+     * @param b Blue saturation (value between 0 and 1).
+     *
+     * Each first letter of the words draws with a permutation of these saturations.
+     */
+    void setRGBsaturation(float r, float g, float b) {
+        sat_r = (r > 1.0f) ? 1.0f : r;
+        sat_g = (g > 1.0f) ? 1.0f : g;
+        sat_b = (b > 1.0f) ? 1.0f : b;
+    }
+
+private:
+    /**
+     * @brief Mobius transformation z -> (az + b) / (cz + d) stored as a 2x2 matrix.
+     */
+    struct Mobius {
+        std::complex<double> a, b, c, d;
+    };
+
+    unsigned int width, height;
+    float zoom, moveX, moveY;
+    float epsilon;
+    int maxDepth;
+    float sat_r, sat_g, sat_b;
+    std::complex<double> ta, tb;
+
+    Mobius gens[4];                  ///< a, b, A = a^-1, B = b^-1.
+    std::complex<double> fix[4][3];  ///< Fixed points of the special words ending in each generator.
+
+    /**
+     * @brief Builds the generators from the traces and computes the special fixed points.
+     */
+    void buildGroup();
+    /**
+     * @brief Explores every reduced word that starts with the given prefix.
+     *
+     * @param word Matrix of the current word.
+     * @param tag Index of the last letter of the word.
+     * @param level Length of the word.
+     * @param letter Color index (the first letter) for the pixels drawn.
+     * @param canvas Per-thread coverage buffer, one byte per pixel (0 = empty).
+     */
+    void branch(const Mobius& word, int tag, int level, unsigned char letter, std::vector<unsigned char>& canvas);
+    /**
+     * @brief Draws a segment between two points of the complex plane.
+     *
+     * Pixels keep the largest letter drawn over them, so overlapping branches resolve the same
+     * way whatever the order of the threads.
+     */
+    void plotSegment(std::complex<double> p, std::complex<double> q, unsigned char letter, std::vector<unsigned char>& canvas);
+    /**
+     * @brief Runs the threaded traversal and colors the image.
+     *
+     * @return std::vector<unsigned char> A vector of bytes representing the generated image in RGBA format.
+     */
+    std::vector<unsigned char> generateKleinianImage();
+};
+
+#endif
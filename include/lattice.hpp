@@ -0,0 +1,59 @@
+#ifndef __LATTICE_HPP__
+#define __LATTICE_HPP__ 1
+
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Integer lattice hash shared by the hashed Perlin lattice and the feature points of Worley noise,
+// so both generators place the same seed on the same cells.
+
+/**
+ * @brief Hashes a lattice cell: the coordinates are spread by two odd multipliers and mixed with
+ * the xxHash32 avalanche. Any int32 cell hashes.
+ */
+inline std::uint32_t latticeHash(std::uint32_t seed, std::int32_t x, std::int32_t y) {
+    std::uint32_t h = seed ^ (static_cast<std::uint32_t>(x) * 0x8da6b343u) ^ (static_cast<std::uint32_t>(y) * 0xd8163841u);
+    h ^= h >> 15;
+    h *= 0x85ebca77u;
+    h ^= h >> 13;
+    h *= 0xc2b2ae3du;
+    return h ^ (h >> 16);
+}
+
+#if defined(__AVX2__)
+
+/**
+ * @brief latticeHash() of eight cells: arithmetic only, no table and no gathers.
+ */
+inline __m256i latticeHash8(__m256i x, __m256i y, __m256i seed) {
+    __m256i h = _mm256_xor_si256(seed, _mm256_xor_si256(_mm256_mullo_epi32(x, _mm256_set1_epi32(0x8da6b343)),
+                                                        _mm256_mullo_epi32(y, _mm256_set1_epi32(static_cast<int>(0xd8163841u)))));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0x85ebca77u)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0xc2b2ae3du)));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+}
+
+#endif
+
+#if defined(__AVX512F__)
+
+/**
+ * @brief latticeHash() of sixteen cells.
+ */
+inline __m512i latticeHash16(__m512i x, __m512i y, __m512i seed) {
+    __m512i h = _mm512_xor_si512(seed, _mm512_xor_si512(_mm512_mullo_epi32(x, _mm512_set1_epi32(0x8da6b343)),
+                                                        _mm512_mullo_epi32(y, _mm512_set1_epi32(static_cast<int>(0xd8163841u)))));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 15));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32(static_cast<int>(0x85ebca77u)));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 13));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32(static_cast<int>(0xc2b2ae3du)));
+    return _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+}
+
+#endif
+
+#endif
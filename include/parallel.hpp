@@ -0,0 +1,57 @@
+#ifndef __PARALLEL_HPP__
+#define __PARALLEL_HPP__ 1
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Gets the number of chunks parallelFor() splits a range into.
+ *
+ * Chunk `k` starts at index `begin + k * ceil(count / chunks)`, so callers can keep scratch per
+ * chunk instead of per thread.
+ *
+ * @param count Number of indices in the range.
+ * @param grain Minimum number of indices per chunk.
+ * @return unsigned int Number of chunks, at least 1.
+ */
+inline unsigned int parallelChunks(unsigned int count, unsigned int grain) {
+    const unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+    return std::max(1u, std::min(hardware, count / std::max(grain, 1u)));
+}
+
+/**
+ * @brief Splits a range of indices into contiguous chunks processed on separate threads.
+ *
+ * `fn(first, last)` is called once per chunk with the half-open range [first, last). The
+ * calling thread processes the first chunk itself. Each chunk covers at least `grain` indices,
+ * so small ranges run on a single thread without spawning anything. Larger ones start their
+ * threads on every call.
+ *
+ * @param begin First index of the range.
+ * @param end One past the last index of the range.
+ * @param grain Minimum number of indices per chunk.
+ * @param fn Callable taking `(unsigned int first, unsigned int last)`.
+ */
+template <typename Fn>
+void parallelFor(unsigned int begin, unsigned int end, unsigned int grain, Fn fn) {
+    if (end <= begin) return;
+    const unsigned int count = end - begin;
+    const unsigned int chunks = parallelChunks(count, grain);
+    if (chunks == 1) {
+        fn(begin, end);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    const unsigned int size = (count + chunks - 1) / chunks;
+    for (unsigned int first = begin + size; first < end; first += size) {
+        threads.emplace_back(fn, first, std::min(first + size, end));
+    }
+    fn(begin, std::min(begin + size, end));
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef __SPECTRAL_HPP__
+#define __SPECTRAL_HPP__ 1
+
+#include <vector>
+#include <string>
+
+/**
+ * @class SpectralNoise
+ * @brief Generates 1/f^beta noise fields by spectral synthesis.
+ *
+ * Every frequency bin of the image receives a random phase and an amplitude of `f^(-beta / 2)`,
+ * so the power spectrum falls off as `1 / f^beta`, and the field is obtained with one inverse
+ * FFT. All frequencies are present at once: the cost is O(N log N) in the number of pixels,
+ * whatever the number of octaves an fBm sum would need for the same range of detail. The field
+ * wraps around at the image edges.
+ *
+ * Any `width` and `height` work (see FFT). `beta = 2` gives rough, cloud-like fields; `beta`
+ * around 3 gives smooth terrain.
+ */
+class SpectralNoise {
+public:
+    /**
+     * @brief Constructor for the spectral noise generator.
+     *
+     * @param w Width of the image.
+     * @param h Height of the image.
+     */
+    SpectralNoise(unsigned int w, unsigned int h);
+
+    /**
+     * @brief Generates the noise image.
+     *
+     * @param imageName File name where the generated image will be saved. The name is generated automatically.
+     *
+     * @return std::vector<unsigned char> A vector representing the generated image in RGBA format.
+     */
+    std::vector<unsigned char> generateImage(std::string& imageName);
+    /**
+     * @brief Renders a rectangular region of the image into an existing buffer.
+     *
+     * The whole field is synthesized on the first call after a parameter changes and then
+     * reused, so regions are cheap to redraw.
+     *
+     * @param image RGBA buffer of `width * height * 4` bytes.
+     * @param x0 Left edge of the region (inclusive).
+     * @param y0 Top edge of the region (inclusive).
+     * @param x1 Right edge of the region (exclusive).
+     * @param y1 Bottom edge of the region (exclusive).
+     * @param step Sample spacing in pixels; each sample fills a `step x step` block (default value: 1).
+     * @param detail Unused: the field always holds every frequency (default value: 1.0).
+     */
+    void renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+        unsigned int x1, unsigned int y1, unsigned int step = 1, float detail = 1.0f);
+
+    /**
+     * @brief Sets the spectral exponent.
+     *
+     * @param b Power falls off as `1 / f^b` (default value: 2.0). Larger values are smoother.
+     */
+    void setExponent(float b) { beta = b; dirty = true; }
+    /**
+     * @brief Sets the seed of the random phases. The same seed and size give the same field.
+     *
+     * @param s Seed (default value: 0).
+     */
+    void setSeed(unsigned int s) { seed = s; dirty = true; }
+    /**
+     * @brief Sets the color mode.
+     *
+     * @param m 0: grayscale, 1: terrain (water, sand, grass, rock and snow), 2: clouds.
+     */
+    void setMode(int m) { mode = m; }
+    /**
+     * @brief Gets the field, synthesizing it if needed.
+     *
+     * @return const std::vector<float>& `width * height` values in [0, 1], row by row.
+     */
+    const std::vector<float>& field();
+
+private:
+    unsigned int width, height;
+    float beta;
+    unsigned int seed;
+    int mode;
+    bool dirty;                 ///< Whether the field must be synthesized again.
+    std::vector<float> heights; ///< Normalized field.
+
+    /**
+     * @brief Fills the half spectrum and transforms it into `heights`.
+     */
+    void synthesize();
+};
+
+#endif
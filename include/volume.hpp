@@ -0,0 +1,109 @@
+#ifndef __VOLUME_HPP__
+#define __VOLUME_HPP__ 1
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class NoiseVolume
+ * @brief 3D density grid stored as a map of compressed bricks.
+ *
+ * The volume is split into bricks of `kBrick^3` voxels. Each voxel is quantized to 8 bits, and
+ * each brick is bit-packed on its own with whichever layout is smaller: the first value of every
+ * row along X followed by the differences between neighbours, or the offsets from the brick's
+ * minimum. Either way the width is the smallest that holds the brick's largest entry, so smooth
+ * noise needs a few bits per voxel instead of the 32 of a float array, and a uniform brick needs
+ * none.
+ *
+ * Any voxel can be read without decoding its brick (at most one row is summed), and slices and
+ * whole bricks decode sequentially for slicing and meshing. Reads are const and may run on
+ * several threads; bricks are written once with storeBrick().
+ */
+class NoiseVolume {
+public:
+    static constexpr unsigned int kBrick = 32; ///< Side of the bricks, in voxels.
+
+    /**
+     * @brief Creates an empty volume (every voxel 0).
+     *
+     * @param x Size along X, in voxels.
+     * @param y Size along Y, in voxels.
+     * @param z Size along Z, in voxels.
+     */
+    NoiseVolume(unsigned int x, unsigned int y, unsigned int z);
+
+    unsigned int sizeX() const { return nx; } ///< Size along X, in voxels.
+    unsigned int sizeY() const { return ny; } ///< Size along Y, in voxels.
+    unsigned int sizeZ() const { return nz; } ///< Size along Z, in voxels.
+    unsigned int bricksX() const { return bx; } ///< Bricks along X.
+    unsigned int bricksY() const { return by; } ///< Bricks along Y.
+    unsigned int bricksZ() const { return bz; } ///< Bricks along Z.
+
+    /**
+     * @brief Gets the quantized value of a voxel.
+     *
+     * @return unsigned char Density, 0 to 255.
+     */
+    unsigned char at(unsigned int x, unsigned int y, unsigned int z) const;
+    /**
+     * @brief Gets the density of a voxel in [0, 1].
+     */
+    float density(unsigned int x, unsigned int y, unsigned int z) const { return at(x, y, z) / 255.0f; }
+    /**
+     * @brief Decodes one brick.
+     *
+     * @param i Brick index along X.
+     * @param j Brick index along Y.
+     * @param k Brick index along Z.
+     * @param out Receives `kBrick^3` values, X fastest, then Y, then Z. Voxels of edge bricks
+     * that fall outside the volume hold padding.
+     */
+    void readBrick(unsigned int i, unsigned int j, unsigned int k, unsigned char* out) const;
+    /**
+     * @brief Decodes the XY plane at height `z`.
+     *
+     * @return std::vector<unsigned char> `sizeX() * sizeY()` values, row by row.
+     */
+    std::vector<unsigned char> slice(unsigned int z) const;
+    /**
+     * @brief Encodes and stores one brick, replacing its previous contents.
+     *
+     * Different bricks may be stored from different threads at the same time.
+     *
+     * @param i Brick index along X.
+     * @param j Brick index along Y.
+     * @param k Brick index along Z.
+     * @param values `kBrick^3` values, in the layout of readBrick().
+     */
+    void storeBrick(unsigned int i, unsigned int j, unsigned int k, const unsigned char* values);
+    /**
+     * @brief Gets the memory held by the compressed bricks, in bytes.
+     */
+    std::size_t memoryUsage() const;
+
+private:
+    /**
+     * @brief One compressed brick. With row starts it stores differences, without them offsets.
+     */
+    struct Brick {
+        unsigned char bits = 0;            ///< Width of the packed entries (0: none stored).
+        unsigned char value = 0;           ///< Minimum of the brick, the base of the offsets.
+        std::vector<unsigned char> starts; ///< First value of each row (kBrick^2), if differences are stored.
+        std::vector<std::uint64_t> packed; ///< Zigzag differences along X (`kBrick - 1` per row) or offsets.
+    };
+
+    unsigned int nx, ny, nz;
+    unsigned int bx, by, bz;
+    std::vector<Brick> bricks;
+
+    const Brick& brick(unsigned int i, unsigned int j, unsigned int k) const {
+        return bricks[(static_cast<std::size_t>(k) * by + j) * bx + i];
+    }
+    /**
+     * @brief Decodes the first `count` voxels of row `row` of a brick.
+     */
+    static void decodeRow(const Brick& b, unsigned int row, unsigned int count, unsigned char* out);
+};
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef __WORLEY_HPP__
+#define __WORLEY_HPP__ 1
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief Value returned by WorleyNoise for each point.
+ */
+enum class WorleyOutput {
+    F1,       ///< Distance to the nearest feature point: round cells with dark centers.
+    F2,       ///< Distance to the second nearest feature point.
+    F2MinusF1 ///< Difference of both: zero on the cell borders, a network of cracks.
+};
+
+/**
+ * @brief Distance used by WorleyNoise.
+ */
+enum class WorleyMetric {
+    Euclidean, ///< Straight-line distance: rounded cells.
+    Manhattan, ///< |dx| + |dy|: diamond-shaped cells.
+    Chebyshev  ///< max(|dx|, |dy|): square cells.
+};
+
+/**
+ * @class WorleyNoise
+ * @brief Generates Worley (cellular) noise: distances to randomly scattered feature points.
+ *
+ * The plane is divided into unit cells holding one feature point each, placed by an integer
+ * hash of the cell coordinates and the seed (the hashed lattice of PerlinNoise), so no point
+ * list is stored and the pattern never repeats. A query scans its own cell and the eight
+ * around it, then the rings further out only while a ring could still hold a point closer
+ * than the current second nearest; each cell of those rings is skipped when its nearest edge
+ * is already too far. AVX2 and AVX-512 builds scan the 3x3 block for eight points per
+ * instruction and finish the few points that need the outer rings one by one.
+ */
+class WorleyNoise {
+public:
+    /**
+     * @brief Constructor for the Worley noise generator.
+     *
+     * @param w Width of the image.
+     * @param h Height of the image.
+     * @param seed Seed of the feature points (default value: 0). See setSeed().
+     */
+    WorleyNoise(unsigned int w, unsigned int h, unsigned int seed = 0);
+
+    /**
+     * @brief Generates a Worley noise image.
+     *
+     * @param imageName File name where the generated image will be saved. The name is generated automatically.
+     *
+     * @return std::vector<unsigned char> A vector representing the generated image in RGBA format.
+     */
+    std::vector<unsigned char> generateImage(std::string& imageName);
+    /**
+     * @brief Renders a rectangular region of the image into an existing buffer.
+     *
+     * @param image RGBA buffer of `width * height * 4` bytes.
+     * @param x0 Left edge of the region (inclusive).
+     * @param y0 Top edge of the region (inclusive).
+     * @param x1 Right edge of the region (exclusive).
+     * @param y1 Bottom edge of the region (exclusive).
+     * @param step Sample spacing in pixels; each sample fills a `step x step` block (default value: 1).
+     * @param detail Unused: every point costs about the same (default value: 1.0).
+     *
+     * Large regions are split by rows across threads.
+     */
+    void renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+        unsigned int x1, unsigned int y1, unsigned int step = 1, float detail = 1.0f);
+    /**
+     * @brief Generates the raw values of the image, one float per pixel.
+     *
+     * @return std::vector<float> `width * height` distances in cells, row by row (see noiseBatch()).
+     */
+    std::vector<float> generateField();
+    /**
+     * @brief Renders the raw values of a region into an existing buffer.
+     *
+     * @param field Buffer of `width * height` floats; only the region is written.
+     * @param x0 Left edge of the region.
+     * @param y0 Top edge of the region.
+     * @param x1 Right edge of the region (exclusive).
+     * @param y1 Bottom edge of the region (exclusive).
+     */
+    void renderField(std::vector<float>& field, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1);
+
+    /**
+     * @brief Evaluates the selected output for a batch of points.
+     *
+     * Coordinates are given as a structure of arrays, in noise space (the image maps pixel `x`
+     * to `x / width * scale`), where feature points are one cell apart on average.
+     *
+     * @param xs X-coordinates, `count` values.
+     * @param ys Y-coordinates, `count` values.
+     * @param out Receives `count` distances in cells: F1 stays below about 1.15 and F2 below
+     * about 1.4 with the Euclidean metric and full jitter.
+     * @param count Number of points.
+     */
+    void noiseBatch(const float* xs, const float* ys, float* out, std::size_t count);
+    /**
+     * @brief Evaluates the distances to the two nearest feature points for a batch of points.
+     *
+     * @param xs X-coordinates, `count` values.
+     * @param ys Y-coordinates, `count` values.
+     * @param f1 Receives `count` distances to the nearest feature point.
+     * @param f2 Receives `count` distances to the second nearest feature point.
+     * @param count Number of points.
+     */
+    void distanceBatch(const float* xs, const float* ys, float* f1, float* f2, std::size_t count);
+
+    /**
+     * @brief Sets the number of cells across the image.
+     *
+     * @param s Scale (default value: 10.0).
+     */
+    void setScale(float s) { scale = s; }
+    /**
+     * @brief Sets the seed of the feature points. The same seed always gives the same noise.
+     *
+     * @param s Seed (default value: 0).
+     */
+    void setSeed(unsigned int s) { seed = s; }
+    /**
+     * @brief Gets the seed of the feature points.
+     *
+     * @return unsigned int The seed set by the constructor or setSeed().
+     */
+    unsigned int getSeed() const { return seed; }
+    /**
+     * @brief Selects the value mapped to the image.
+     *
+     * @param o Output. Default: WorleyOutput::F1.
+     */
+    void setOutput(WorleyOutput o) { output = o; }
+    /**
+     * @brief Selects the distance metric.
+     *
+     * @param m Metric. Default: WorleyMetric::Euclidean.
+     */
+    void setMetric(WorleyMetric m) { metric = m; }
+    /**
+     * @brief Sets how far the feature points stray from the centers of their cells.
+     *
+     * @param j Fraction of the cell, 0 (a regular grid) to 1 (anywhere in the cell; default value).
+     */
+    void setJitter(float j) { jitter = j < 0.0f ? 0.0f : (j > 1.0f ? 1.0f : j); }
+    /**
+     * @brief Moves the image over the unbounded noise plane, as PerlinNoise::setOrigin() does.
+     *
+     * @param x World X-coordinate of the top-left pixel, in pixels. Default: 0.
+     * @param y World Y-coordinate of the top-left pixel, in pixels. Default: 0.
+     */
+    void setOrigin(double x, double y) { originX = x; originY = y; }
+    /**
+     * @brief Gets the width of the image.
+     *
+     * @return unsigned int Width in pixels.
+     */
+    unsigned int getWidth() const { return width; }
+
+private:
+    unsigned int width, height;
+    float scale;
+    unsigned int seed;
+    WorleyOutput output;
+    WorleyMetric metric;
+    float jitter;
+    double originX, originY;
+
+    /**
+     * @brief Evaluates the selected output of a region a row of samples at a time.
+     *
+     * Rows are split across threads; `emit(y, values)` receives the image row `y` and its
+     * samples, one every `step` pixels from `x0`, and may be called from several threads at once.
+     */
+    void evaluateRegion(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1,
+        unsigned int step, const std::function<void(unsigned int, const float*)>& emit);
+};
+
+#endif
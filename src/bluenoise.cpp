@@ -0,0 +1,323 @@
+#include "../include/bluenoise.hpp"
+#include "../include/image_utils.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+// Side of the blocks whose tightest cluster and largest void are cached
+constexpr unsigned int kBlock = 8;
+// Fraction of pixels set in the initial random pattern
+constexpr float kInitialDensity = 0.1f;
+
+// Draws the pixels of the initial pattern with splitmix64: fixed across platforms and standard
+// libraries, unlike the distributions of <random>, so a seed gives the same mask everywhere
+class PixelDraw {
+public:
+    explicit PixelDraw(unsigned int seed) : state(seed) {}
+
+    // Pixel in [0, n), n > 0
+    std::uint32_t operator()(std::uint32_t n) {
+        state += 0x9e3779b97f4a7c15ull;
+        std::uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z ^= z >> 31;
+        return static_cast<std::uint32_t>(z % n);
+    }
+
+private:
+    std::uint64_t state;
+};
+
+// Tightest cluster (highest energy among the set pixels) and largest void (lowest energy
+// among the empty ones) of a group of pixels
+struct Extremes {
+    float clusterEnergy;
+    std::uint32_t cluster;
+    float voidEnergy;
+    std::uint32_t hole;
+
+    void merge(const Extremes& other) {
+        if (other.clusterEnergy > clusterEnergy) {
+            clusterEnergy = other.clusterEnergy;
+            cluster = other.cluster;
+        }
+        if (other.voidEnergy < voidEnergy) {
+            voidEnergy = other.voidEnergy;
+            hole = other.hole;
+        }
+    }
+};
+
+const Extremes kEmpty = { -std::numeric_limits<float>::infinity(), 0, std::numeric_limits<float>::infinity(), 0 };
+
+// Binary pattern with its energy field and the cached extremes
+class Pattern {
+public:
+    Pattern(unsigned int w, unsigned int h, float sigma, bool wrap)
+        : width(w), height(h), wrap(wrap),
+          blocksX((w + kBlock - 1) / kBlock), blocksY((h + kBlock - 1) / kBlock),
+          bits(static_cast<std::size_t>(w) * h, 0), energy(bits.size(), 0.0f), weight(bits.size(), 1.0f),
+          leaves(1)
+    {
+        while (leaves < blocksX * blocksY) leaves *= 2;
+        tree.assign(2 * leaves, kEmpty);
+        // The window must not overlap itself when it wraps around a small mask
+        radius = static_cast<int>(std::ceil(3.5f * sigma));
+        radius = std::max(0, std::min(radius, static_cast<int>((std::min(w, h) - 1) / 2)));
+        for (int d = -radius; d <= radius; d++) {
+            gauss.push_back(std::exp(-0.5f * d * d / (sigma * sigma)));
+        }
+
+        // Without wrapping, the window of a pixel near an edge loses the kernel weight that
+        // falls outside the mask, and border pixels would always look like voids. Energies are
+        // compared as densities instead: the energy of the other points divided by the weight
+        // they could occupy, the window inside the mask minus the center (whose weight is 1).
+        // On a torus the weight is the same everywhere and the ranking is unchanged.
+        const std::vector<float> massX = kernelMass(w), massY = kernelMass(h);
+        for (unsigned int y = 0; y < h; y++) {
+            for (unsigned int x = 0; x < w; x++) {
+                const float others = massX[x] * massY[y] - 1.0f;
+                weight[static_cast<std::size_t>(y) * w + x] = others > 0.0f ? 1.0f / others : 1.0f;
+            }
+        }
+    }
+
+    unsigned int size() const { return static_cast<unsigned int>(bits.size()); }
+    bool isSet(std::uint32_t p) const { return bits[p] != 0; }
+
+    void set(std::uint32_t p) { bits[p] = 1; }
+
+    // Energy of the whole pattern, with the Gaussian applied as two 1D passes
+    void computeEnergy() {
+        std::vector<float> horizontal(energy.size());
+        for (unsigned int y = 0; y < height; y++) {
+            for (unsigned int x = 0; x < width; x++) {
+                float sum = 0.0f;
+                for (int d = -radius; d <= radius; d++) {
+                    int sx = static_cast<int>(x) + d;
+                    if (!wrapCoordinate(sx, width)) continue;
+                    sum += gauss[d + radius] * bits[static_cast<std::size_t>(y) * width + sx];
+                }
+                horizontal[static_cast<std::size_t>(y) * width + x] = sum;
+            }
+        }
+        for (unsigned int y = 0; y < height; y++) {
+            for (unsigned int x = 0; x < width; x++) {
+                float sum = 0.0f;
+                for (int d = -radius; d <= radius; d++) {
+                    int sy = static_cast<int>(y) + d;
+                    if (!wrapCoordinate(sy, height)) continue;
+                    sum += gauss[d + radius] * horizontal[static_cast<std::size_t>(sy) * width + x];
+                }
+                energy[static_cast<std::size_t>(y) * width + x] = sum;
+            }
+        }
+        for (unsigned int by = 0; by < blocksY; by++) {
+            for (unsigned int bx = 0; bx < blocksX; bx++) {
+                refreshBlock(bx, by);
+            }
+        }
+    }
+
+    // Sets or clears a pixel, updating the energy in its window and the affected caches
+    void toggle(std::uint32_t p) {
+        const float sign = bits[p] ? -1.0f : 1.0f;
+        bits[p] ^= 1;
+        const int px = static_cast<int>(p % width);
+        const int py = static_cast<int>(p / width);
+        for (int dy = -radius; dy <= radius; dy++) {
+            int y = py + dy;
+            if (!wrapCoordinate(y, height)) continue;
+            const float gy = sign * gauss[dy + radius];
+            float* row = &energy[static_cast<std::size_t>(y) * width];
+            for (int dx = -radius; dx <= radius; dx++) {
+                int x = px + dx;
+                if (!wrapCoordinate(x, width)) continue;
+                row[x] += gy * gauss[dx + radius];
+            }
+        }
+
+        touchedBlocks(px, width, blocksX, spanX);
+        touchedBlocks(py, height, blocksY, spanY);
+        for (unsigned int by : spanY) {
+            for (unsigned int bx : spanX) {
+                refreshBlock(bx, by);
+            }
+        }
+    }
+
+    Extremes extremes() const { return tree[1]; }
+
+private:
+    unsigned int width, height;
+    bool wrap;
+    unsigned int blocksX, blocksY;
+    int radius;
+    std::vector<float> gauss;            // 1D kernel over [-radius, radius]
+    std::vector<unsigned char> bits;
+    std::vector<float> energy;
+    std::vector<float> weight;           // 1 / kernel weight of the other pixels in each window
+    unsigned int leaves;
+    std::vector<Extremes> tree;          // Tournament tree over the blocks: leaves at [leaves, 2 * leaves)
+    std::vector<unsigned int> spanX, spanY;
+
+    // Maps a coordinate into the mask; false when it falls outside a mask that does not wrap
+    bool wrapCoordinate(int& c, unsigned int size) const {
+        if (c >= 0 && c < static_cast<int>(size)) return true;
+        if (!wrap) return false;
+        c = c < 0 ? c + static_cast<int>(size) : c - static_cast<int>(size);
+        return true;
+    }
+
+    // Kernel weight of the window of each coordinate along one axis that lies inside the mask
+    std::vector<float> kernelMass(unsigned int size) const {
+        std::vector<float> mass(size, 0.0f);
+        for (unsigned int c = 0; c < size; c++) {
+            for (int d = -radius; d <= radius; d++) {
+                int s = static_cast<int>(c) + d;
+                if (wrapCoordinate(s, size)) mass[c] += gauss[d + radius];
+            }
+        }
+        return mass;
+    }
+
+    // Blocks covered by the window [c - radius, c + radius] along one axis
+    void touchedBlocks(int c, unsigned int size, unsigned int count, std::vector<unsigned int>& out) const {
+        out.clear();
+        auto span = [&](int lo, int hi) {
+            for (unsigned int b = lo / kBlock; b <= hi / kBlock && b < count; b++) {
+                if (std::find(out.begin(), out.end(), b) == out.end()) out.push_back(b);
+            }
+        };
+        const int lo = c - radius, hi = c + radius, last = static_cast<int>(size) - 1;
+        span(std::max(lo, 0), std::min(hi, last));
+        if (wrap && lo < 0) span(lo + static_cast<int>(size), last);
+        if (wrap && hi > last) span(0, hi - static_cast<int>(size));
+    }
+
+    void refreshBlock(unsigned int bx, unsigned int by) {
+        Extremes e = kEmpty;
+        const unsigned int x1 = std::min(width, (bx + 1) * kBlock);
+        const unsigned int y1 = std::min(height, (by + 1) * kBlock);
+        for (unsigned int y = by * kBlock; y < y1; y++) {
+            for (unsigned int x = bx * kBlock; x < x1; x++) {
+                const std::uint32_t p = y * width + x;
+                // Selects instead of a branch on the pattern, which is random. A set pixel
+                // leaves out its own energy.
+                const float v = (energy[p] - bits[p]) * weight[p];
+                const float asCluster = bits[p] ? v : kEmpty.clusterEnergy;
+                const float asVoid = bits[p] ? kEmpty.voidEnergy : v;
+                if (asCluster > e.clusterEnergy) { e.clusterEnergy = asCluster; e.cluster = p; }
+                if (asVoid < e.voidEnergy) { e.voidEnergy = asVoid; e.hole = p; }
+            }
+        }
+        unsigned int node = leaves + by * blocksX + bx;
+        tree[node] = e;
+        for (node /= 2; node > 0; node /= 2) {
+            tree[node] = tree[2 * node];
+            tree[node].merge(tree[2 * node + 1]);
+        }
+    }
+};
+
+}
+
+BlueNoise::BlueNoise(unsigned int w, unsigned int h)
+    : width(w), height(h)
+{
+    sigma = 1.5f;
+    seed = 0;
+    tileable = true;
+    dirty = true;
+}
+
+std::vector<unsigned char> BlueNoise::generateImage(std::string& imageName)
+{
+    std::vector<unsigned char> image(width * height * 4);
+    renderRegion(image, 0, 0, width, height);
+    imageName = "../assets/blue_noise_" + generateUniqueFileName();
+    return image;
+}
+
+const std::vector<float>& BlueNoise::mask()
+{
+    if (dirty) {
+        generate();
+        dirty = false;
+    }
+    return thresholds;
+}
+
+void BlueNoise::generate()
+{
+    if (width == 0 || height == 0) {
+        thresholds.clear();
+        return;
+    }
+    Pattern pattern(width, height, sigma, tileable);
+    const unsigned int n = pattern.size();
+
+    // Initial random pattern
+    PixelDraw pick(seed);
+    const unsigned int initial = std::max(1u, static_cast<unsigned int>(n * kInitialDensity));
+    for (unsigned int placed = 0; placed < initial;) {
+        const std::uint32_t p = pick(n);
+        if (!pattern.isSet(p)) {
+            pattern.set(p);
+            placed++;
+        }
+    }
+    pattern.computeEnergy();
+
+    // Move the tightest cluster into the largest void until it would land where it came from
+    for (unsigned int i = 0; i < n; i++) {
+        const std::uint32_t cluster = pattern.extremes().cluster;
+        pattern.toggle(cluster);
+        const std::uint32_t hole = pattern.extremes().hole;
+        pattern.toggle(hole);
+        if (hole == cluster) break;
+    }
+
+    std::vector<std::uint32_t> rank(n);
+    const Pattern prototype = pattern;
+
+    // Phase 1: remove the points of the initial pattern, tightest cluster first
+    for (unsigned int r = initial; r-- > 0;) {
+        const std::uint32_t cluster = pattern.extremes().cluster;
+        pattern.toggle(cluster);
+        rank[cluster] = r;
+    }
+
+    // Phases 2 and 3: fill the largest void until the mask is full. Past half the pixels
+    // Ulichney looks for the tightest cluster of empty pixels instead. The densities compared
+    // are normalized by the weight of each window, so the density of empty pixels around an
+    // empty pixel is one minus that of the set ones, and that is the empty pixel with the
+    // lowest density all the same, with or without wrapping.
+    pattern = prototype;
+    for (unsigned int r = initial; r < n; r++) {
+        const std::uint32_t hole = pattern.extremes().hole;
+        pattern.toggle(hole);
+        rank[hole] = r;
+    }
+
+    thresholds.resize(n);
+    for (unsigned int p = 0; p < n; p++) {
+        thresholds[p] = (rank[p] + 0.5f) / n;
+    }
+}
+
+void BlueNoise::renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, float)
+{
+    const std::vector<float>& values = mask();
+    for (unsigned int y = y0; y < y1; y += step) {
+        for (unsigned int x = x0; x < x1; x += step) {
+            const unsigned char v = static_cast<unsigned char>(values[static_cast<std::size_t>(y) * width + x] * 256.0f);
+            // Each sample covers a step x step block
+            fillBlock(image, width, x, y, std::min(step, x1 - x), std::min(step, y1 - y), v, v, v, 255);
+        }
+    }
+}
@@ -1,66 +1,346 @@
 #include "../include/conway.hpp"
+#include "../include/parallel.hpp"
+#include "../include/bits.hpp"
 #include <cstdlib>
 #include <ctime>
+#include <cstring>
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
+namespace {
 
-GameOfLife::GameOfLife(unsigned int w, unsigned int h): width(w), height(h) {
-    grid.resize(height, std::vector<int>(width, 0));
+// Words per thread below which a generation is not split
+constexpr unsigned int kParallelWords = 1u << 14;
+// Tile flags: different from two generations ago, or edited since the last generation
+constexpr unsigned char kChanged = 1;
+constexpr unsigned char kEdited = 2;
+
+// Neighbour counts of words [first, last) of one row, bit-sliced: for every cell, its west and
+// east neighbours added (sum and carry bits) and the same plus the cell itself (bits 0 and 1 of a
+// count up to 3)
+using RowSums = LifeStepScratch::RowSums;
+
+// Sums of word `i`; `pad` holds the row between a guard word on each side
+inline void sumWord(const std::uint64_t* pad, std::size_t i, std::uint64_t eastFix, RowSums& out) {
+    const std::uint64_t mid = pad[i + 1];
+    const std::uint64_t west = (mid << 1) | (pad[i] >> 63);
+    const std::uint64_t east = (mid >> 1) | (pad[i + 2] << 63) | eastFix;
+    const std::uint64_t s = west ^ east;
+    const std::uint64_t c = west & east;
+    out.s[i] = s;
+    out.c[i] = c;
+    out.t0[i] = s ^ mid;
+    out.t1[i] = c | (s & mid);
+}
+
+void sumRow(const std::uint64_t* row, unsigned int words, unsigned int width, unsigned int first, unsigned int last, RowSums& out) {
+    if (out.s.size() < words) {
+        out.pad.resize(words + 2);
+        out.s.resize(words);
+        out.c.resize(words);
+        out.t0.resize(words);
+        out.t1.resize(words);
+    }
+    // The guards wrap the row around: the west neighbour of cell 0 is the last cell, and the
+    // east neighbour of the last cell is cell 0 (patched into a partial last word below)
+    const unsigned int tail = width & 63;
+    const std::uint64_t firstCell = row[0] & 1;
+    std::uint64_t* pad = out.pad.data();
+    pad[0] = ((row[(width - 1) >> 6] >> ((width - 1) & 63)) & 1) << 63;
+    pad[words + 1] = tail ? 0 : firstCell;
+    const unsigned int from = first ? first - 1 : 0;
+    const unsigned int to = std::min(last + 1, words);
+    std::memcpy(pad + 1 + from, row + from, (to - from) * sizeof(std::uint64_t));
+
+    unsigned int i = first;
+#if defined(__AVX2__)
+    for (; i + 4 <= last; i += 4) {
+        const __m256i mid = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + i + 1));
+        const __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + i));
+        const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + i + 2));
+        const __m256i west = _mm256_or_si256(_mm256_slli_epi64(mid, 1), _mm256_srli_epi64(left, 63));
+        const __m256i east = _mm256_or_si256(_mm256_srli_epi64(mid, 1), _mm256_slli_epi64(right, 63));
+        const __m256i s = _mm256_xor_si256(west, east);
+        const __m256i c = _mm256_and_si256(west, east);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.s[i]), s);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.c[i]), c);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.t0[i]), _mm256_xor_si256(s, mid));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.t1[i]), _mm256_or_si256(c, _mm256_and_si256(s, mid)));
+    }
+#endif
+    for (; i < last; i++) {
+        sumWord(pad, i, 0, out);
+    }
+    if (tail && last == words) {
+        sumWord(pad, words - 1, firstCell << (tail - 1), out);
+    }
+}
+
+// Next state of 64 cells from the sums of the rows above and below (three cells each) and of
+// the row itself (two cells): a count of 2 keeps the cell as it is, a count of 3 makes it alive
+inline std::uint64_t ruleWord(std::uint64_t a0, std::uint64_t a1, std::uint64_t b0, std::uint64_t b1,
+    std::uint64_t s, std::uint64_t c, std::uint64_t alive) {
+    const std::uint64_t x0 = a0 ^ b0 ^ s;
+    const std::uint64_t k = (a0 & b0) | (s & (a0 ^ b0));
+    // Weight-2 bits a1, b1, c and the carry k: the count is 2 or 3 when exactly one is set
+    const std::uint64_t u = a1 ^ b1;
+    const std::uint64_t v = c ^ k;
+    const std::uint64_t one = (u ^ v) & ~((a1 & b1) | (c & k));
+    return one & (x0 | alive);
+}
+
+// Writes the pixels of cells [x0, x1) of a row: white when alive, black and transparent when dead.
+// `x0` is a multiple of 8
+void expandRow(const std::uint64_t* row, unsigned int x0, unsigned int x1, unsigned char* out) {
+    unsigned int x = x0;
+#if defined(__AVX2__)
+    // Eight cells at a time: each lane keeps one bit of the byte and turns it into a pixel
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    for (; x + 8 <= x1; x += 8) {
+        const int byte = static_cast<int>((row[x >> 6] >> (x & 63)) & 0xff);
+        const __m256i lanes = _mm256_and_si256(_mm256_set1_epi32(byte), bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + (x - x0) * 4), _mm256_cmpeq_epi32(lanes, bits));
+    }
+#endif
+    for (; x < x1; x++) {
+        const std::uint32_t pixel = 0u - static_cast<std::uint32_t>((row[x >> 6] >> (x & 63)) & 1);
+        std::memcpy(out + (x - x0) * 4, &pixel, 4);
+    }
+}
+
+// Finds the sums of words [first, last) of `row` among the three slots, computing them over a
+// slot that none of the rows in `keep` uses for the same words
+const RowSums& rowSums(RowSums* slots, unsigned int row, unsigned int first, unsigned int last,
+    const unsigned int* keep, const std::uint64_t* cells, unsigned int words, unsigned int width) {
+    auto holds = [first, last](const RowSums& slot, unsigned int r) {
+        return slot.row == r && slot.first == first && slot.last == last;
+    };
+    for (int i = 0; i < 3; i++) {
+        if (holds(slots[i], row)) return slots[i];
+    }
+    for (int i = 0; i < 3; i++) {
+        if (!holds(slots[i], keep[0]) && !holds(slots[i], keep[1]) && !holds(slots[i], keep[2])) {
+            sumRow(cells + static_cast<std::size_t>(row) * words, words, width, first, last, slots[i]);
+            slots[i].row = row;
+            slots[i].first = first;
+            slots[i].last = last;
+            return slots[i];
+        }
+    }
+    return slots[0];
+}
+
+}
+
+GameOfLife::GameOfLife(unsigned int w, unsigned int h)
+    : width(w), height(h), words((w + 63) / 64),
+      cells(static_cast<std::size_t>(words) * h, 0), next(cells.size(), 0),
+      tileRows((h + kTileHeight - 1) / kTileHeight), stale(static_cast<std::size_t>(words) * tileRows, 1),
+      changed(stale.size(), kEdited), flipped(stale.size(), 0), active(stale.size(), 0) {
     //srand(time(0)); // Semilla para valores aleatorios
     srand(54); // Semilla fija
 
     // Inicializar la cuadrícula con valores aleatorios
     for (unsigned int y = 0; y < height; ++y) {
         for (unsigned int x = 0; x < width; ++x) {
-            //grid[y][x] = rand() % 2; // Célula viva (1) o muerta (0)
-            grid[y][x] = (rand() % 100 < 30) ? 1 : 0;
+            //setCell(x, y, rand() % 2); // Célula viva (1) o muerta (0)
+            setCell(x, y, rand() % 100 < 30);
         }
     }
 }
 
-int GameOfLife::countNeighbors(int x, int y) {
-    int count = 0;
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            if (dx == 0 && dy == 0) continue; // Saltar la celda actual
-            int nx = (x + dx + width) % width;  // Borde toroidal en X
-            int ny = (y + dy + height) % height; // Borde toroidal en Y
-            count += grid[ny][nx];
-        }
+void GameOfLife::setCell(unsigned int x, unsigned int y, bool alive) {
+    std::uint64_t& word = cells[static_cast<std::size_t>(y) * words + (x >> 6)];
+    const std::uint64_t bit = std::uint64_t(1) << (x & 63);
+    word = alive ? (word | bit) : (word & ~bit);
+    const std::size_t tile = static_cast<std::size_t>(y / kTileHeight) * words + (x >> 6);
+    stale[tile] = 1;
+    changed[tile] = kEdited;
+}
+
+void GameOfLife::clear() {
+    std::fill(cells.begin(), cells.end(), 0);
+    std::fill(stale.begin(), stale.end(), 1);
+    std::fill(changed.begin(), changed.end(), kEdited);
+}
+
+std::size_t GameOfLife::population() const {
+    std::size_t count = 0;
+    for (std::uint64_t word : cells) {
+        count += popcount64(word);
     }
     return count;
 }
 
-void GameOfLife::nextGeneration() {
-    std::vector<std::vector<int>> newGrid(height, std::vector<int>(width, 0));
+void GameOfLife::stepTiles(unsigned int first, unsigned int last, LifeStepScratch& scratch) {
+    // Each row's sums are used by the rows above and below it too, so a band keeps three
+    RowSums* slots = scratch.slots;
+    for (int i = 0; i < 3; i++) {
+        slots[i].row = -1;
+    }
+    // Bits of each word that differ from the last generation and from the one before it,
+    // gathered over the rows of a tile
+    std::vector<std::uint64_t>& flips = scratch.flips;
+    std::vector<std::uint64_t>& changes = scratch.changes;
+    flips.assign(words, 0);
+    changes.assign(words, 0);
+    const std::uint64_t lastMask = (width & 63) ? (std::uint64_t(1) << (width & 63)) - 1 : ~std::uint64_t(0);
 
-    for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            int neighbors = countNeighbors(x, y);
+    for (unsigned int ty = first; ty < last; ty++) {
+        const std::size_t tiles = static_cast<std::size_t>(ty) * words;
+        const unsigned int yEnd = std::min((ty + 1) * kTileHeight, height);
+        // Runs of active tiles along the row of tiles; the rest is left as it is in `next`
+        for (unsigned int w0 = 0; w0 < words; ) {
+            if (!active[tiles + w0]) {
+                w0++;
+                continue;
+            }
+            unsigned int w1 = w0 + 1;
+            while (w1 < words && active[tiles + w1]) w1++;
+
+            for (unsigned int y = ty * kTileHeight; y < yEnd; y++) {
+                const unsigned int keep[3] = { (y + height - 1) % height, y, (y + 1) % height };
+                const RowSums& above = rowSums(slots, keep[0], w0, w1, keep, cells.data(), words, width);
+                const RowSums& below = rowSums(slots, keep[2], w0, w1, keep, cells.data(), words, width);
+                const RowSums& mid = rowSums(slots, keep[1], w0, w1, keep, cells.data(), words, width);
+                const std::uint64_t* alive = &cells[static_cast<std::size_t>(y) * words];
+                std::uint64_t* out = &next[static_cast<std::size_t>(y) * words];
+
+                unsigned int i = w0;
+#if defined(__AVX2__)
+                for (; i + 4 <= w1; i += 4) {
+                    auto load = [i](const std::vector<std::uint64_t>& v) {
+                        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&v[i]));
+                    };
+                    const __m256i a0 = load(above.t0), a1 = load(above.t1);
+                    const __m256i b0 = load(below.t0), b1 = load(below.t1);
+                    const __m256i s = load(mid.s), c = load(mid.c);
+                    const __m256i self = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(alive + i));
+                    const __m256i before = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(out + i));
+                    const __m256i a0b0 = _mm256_xor_si256(a0, b0);
+                    const __m256i x0 = _mm256_xor_si256(a0b0, s);
+                    const __m256i k = _mm256_or_si256(_mm256_and_si256(a0, b0), _mm256_and_si256(s, a0b0));
+                    const __m256i u = _mm256_xor_si256(a1, b1);
+                    const __m256i v = _mm256_xor_si256(c, k);
+                    const __m256i many = _mm256_or_si256(_mm256_and_si256(a1, b1), _mm256_and_si256(c, k));
+                    const __m256i one = _mm256_andnot_si256(many, _mm256_xor_si256(u, v));
+                    const __m256i result = _mm256_and_si256(one, _mm256_or_si256(x0, self));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+                    __m256i* flip = reinterpret_cast<__m256i*>(&flips[i]);
+                    __m256i* change = reinterpret_cast<__m256i*>(&changes[i]);
+                    _mm256_storeu_si256(flip, _mm256_or_si256(_mm256_loadu_si256(flip), _mm256_xor_si256(result, self)));
+                    _mm256_storeu_si256(change, _mm256_or_si256(_mm256_loadu_si256(change), _mm256_xor_si256(result, before)));
+                }
+#endif
+                for (; i < w1; i++) {
+                    const std::uint64_t before = out[i];
+                    out[i] = ruleWord(above.t0[i], above.t1[i], below.t0[i], below.t1[i], mid.s[i], mid.c[i], alive[i]);
+                    flips[i] |= out[i] ^ alive[i];
+                    changes[i] |= out[i] ^ before;
+                }
+                if (w1 == words) {
+                    out[words - 1] &= lastMask;
+                    flips[words - 1] &= lastMask;
+                    changes[words - 1] &= lastMask;
+                }
+            }
+            w0 = w1;
+        }
+
+        // A skipped tile alternates as it did, so it keeps its flag for the image
+        for (unsigned int w = 0; w < words; w++) {
+            const std::size_t t = tiles + w;
+            if (active[t]) {
+                flipped[t] = flips[w] != 0;
+                changed[t] = (changes[w] != 0 || active[t] == kEdited) ? kChanged : 0;
+                flips[w] = 0;
+                changes[w] = 0;
+            } else {
+                changed[t] = 0;
+            }
+            stale[t] |= flipped[t];
+        }
+    }
+}
 
-            if (grid[y][x] == 1) { // Celda viva
-                newGrid[y][x] = (neighbors == 2 || neighbors == 3) ? 1 : 0;
-            } else { // Celda muerta
-                newGrid[y][x] = (neighbors == 3) ? 1 : 0;
+void GameOfLife::nextGeneration() {
+    if (cells.empty()) return;
+
+    // A tile needs computing when it or a neighbour (across the wrapped edges too) differs from
+    // two generations ago: otherwise it repeats the generation before this one, which `next`
+    // still holds. Edited tiles also count as changed in the following generation, since the
+    // generation before them was not their predecessor
+    std::fill(active.begin(), active.end(), 0);
+    for (unsigned int ty = 0; ty < tileRows; ty++) {
+        for (unsigned int w = 0; w < words; w++) {
+            const unsigned char flag = changed[static_cast<std::size_t>(ty) * words + w];
+            if (!flag) continue;
+            for (unsigned int dy = 0; dy < 3; dy++) {
+                const std::size_t row = static_cast<std::size_t>((ty + tileRows + dy - 1) % tileRows) * words;
+                for (unsigned int dx = 0; dx < 3; dx++) {
+                    unsigned char& a = active[row + (w + words + dx - 1) % words];
+                    a = std::max(a, kChanged);
+                }
+            }
+            if (flag == kEdited) {
+                active[static_cast<std::size_t>(ty) * words + w] = kEdited;
             }
         }
     }
 
-    grid = newGrid; // Actualizar la cuadrícula
+    // Threads take whole rows of tiles so that no two of them mark the same tile. Each chunk
+    // of rows has its own scratch, sized by the first generation and reused afterwards
+    const unsigned int grain = std::max(1u, kParallelWords / (words * kTileHeight));
+    const unsigned int chunks = parallelChunks(tileRows, grain);
+    const unsigned int chunkRows = (tileRows + chunks - 1) / chunks;
+    if (scratch.size() < chunks) scratch.resize(chunks);
+    parallelFor(0, tileRows, grain, [this, chunkRows](unsigned int first, unsigned int last) {
+        stepTiles(first, last, scratch[first / chunkRows]);
+    });
+    cells.swap(next); // Actualizar la cuadrícula
 }
 
 std::vector<unsigned char> GameOfLife::generateImage() {
-    std::vector<unsigned char> image(width * height * 4, 0); // Imagen negra (RGBA)
+    std::vector<unsigned char> image(static_cast<std::size_t>(width) * height * 4); // Imagen negra (RGBA)
 
     for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            int idx = (y * width + x) * 4;
-            if (grid[y][x] == 1) {
-                image[idx] = 255;     // Rojo
-                image[idx + 1] = 255; // Verde
-                image[idx + 2] = 255; // Azul
-                image[idx + 3] = 255; // Alfa
-            }
-        }
+        expandRow(&cells[static_cast<std::size_t>(y) * words], 0, width, &image[static_cast<std::size_t>(y) * width * 4]);
     }
     return image;
-}
\ No newline at end of file
+}
+
+const std::vector<LifeRegion>& GameOfLife::updateRegions() {
+    // Runs of stale tiles along each row of tiles become one rectangle
+    regions.clear();
+    std::size_t bytes = 0;
+    for (unsigned int ty = 0; ty < tileRows; ty++) {
+        const unsigned char* flags = &stale[static_cast<std::size_t>(ty) * words];
+        for (unsigned int w = 0; w < words; w++) {
+            if (!flags[w]) continue;
+            unsigned int end = w + 1;
+            while (end < words && flags[end]) end++;
+            LifeRegion r;
+            r.x = w * 64;
+            r.y = ty * kTileHeight;
+            r.width = std::min(end * 64, width) - r.x;
+            r.height = std::min(r.y + kTileHeight, height) - r.y;
+            r.offset = bytes;
+            bytes += static_cast<std::size_t>(r.width) * r.height * 4;
+            regions.push_back(r);
+            w = end;
+        }
+    }
+    // The first call covers the whole grid, so later ones fit in the same buffer
+    regionBuffer.resize(bytes);
+
+    for (const LifeRegion& r : regions) {
+        unsigned char* out = &regionBuffer[r.offset];
+        for (unsigned int y = r.y; y < r.y + r.height; y++, out += r.width * 4) {
+            expandRow(&cells[static_cast<std::size_t>(y) * words], r.x, r.x + r.width, out);
+        }
+    }
+    std::fill(stale.begin(), stale.end(), 0);
+    return regions;
+}
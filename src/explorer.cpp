@@ -0,0 +1,260 @@
+#include "../include/explorer.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// Cada sonda se divide en kTiles x kTiles tiles; bajar un nivel acerca la vista kTiles veces
+constexpr int kTiles = 4;
+// Muestras mínimas por lado de cada tile, aunque la imagen final sea pequeña
+constexpr int kMinTileSamples = 4;
+// Fracción de las muestras de la imagen final que pueden gastar todas las sondas
+constexpr double kProbeBudget = 0.01;
+// Contenedores del histograma de iteraciones
+constexpr int kBins = 16;
+// Límite de precisión de float: por debajo de este tamaño de píxel la imagen se pixela
+constexpr double kPrecisionLimit = 1e-6;
+
+int samplesPerSide(double samples) {
+    int n = static_cast<int>(std::sqrt(std::max(samples, 0.0))) / kTiles * kTiles;
+    return std::max(n, kTiles * kMinTileSamples);
+}
+
+}
+
+FractalExplorer::FractalExplorer(unsigned int w, unsigned int h, float zoom, float moveX, float moveY, int maxIterations)
+    : width(w), height(h), startZoom(zoom), startX(moveX), startY(moveY), baseIterations(maxIterations)
+{
+    depth = 6;
+    julia = false;
+    c_re = 0.0;
+    c_im = 0.0;
+    nucleusSearch = false;
+    probeSamples = 0;
+}
+
+std::vector<ExplorerTarget> FractalExplorer::explore(int count) {
+    probeSamples = 0;
+    std::vector<ExplorerTarget> targets;
+    if (count <= 0) return targets;
+
+    // Presupuesto de muestras: la primera sonda es común, el resto se reparte entre los descensos.
+    // Si ni con sondas mínimas caben todos los niveles, se reduce la profundidad.
+    const double budget = kProbeBudget * width * height;
+    const double minProbe = static_cast<double>(kTiles * kMinTileSamples) * (kTiles * kMinTileSamples);
+    const int maxProbes = std::max(1, static_cast<int>(budget / minProbe));
+    const int levels = std::max(1, std::min(depth, 1 + (maxProbes - 1) / count));
+    const double perProbe = budget / (1.0 + count * (levels - 1));
+    const double aspect = static_cast<double>(height) / width;
+    const int gx = samplesPerSide(perProbe / aspect);
+    const int gy = samplesPerSide(perProbe * aspect);
+    const int tw = gx / kTiles;
+    const int th = gy / kTiles;
+
+    // El límite de iteraciones crece con la profundidad (un 50% por nivel)
+    auto iterationsFor = [this](double zoom) {
+        return static_cast<int>(baseIterations * (1.0 + 0.25 * std::log2(std::max(zoom / startZoom, 1.0))));
+    };
+    // Centro de un tile de la vista (cx, cy, zoom)
+    auto tileCenter = [&](int t, double cx, double cy, double zoom, double& ox, double& oy) {
+        ox = cx + ((t % kTiles + 0.5) / kTiles - 0.5) * width / zoom;
+        oy = cy + ((t / kTiles + 0.5) / kTiles - 0.5) * height / zoom;
+    };
+    auto scoreAll = [&](const std::vector<int>& counts, int maxIterations) {
+        std::vector<float> scores(kTiles * kTiles);
+        for (int t = 0; t < kTiles * kTiles; ++t) {
+            scores[t] = scoreTile(counts, gx, (t % kTiles) * tw, (t / kTiles) * th, tw, th, maxIterations);
+        }
+        return scores;
+    };
+
+    // Primer nivel: se ordenan los tiles y cada descenso empieza en uno distinto
+    const int rootIterations = iterationsFor(startZoom);
+    std::vector<float> rootScores = scoreAll(probe(startX, startY, startZoom, gx, gy, rootIterations), rootIterations);
+    std::vector<int> order(kTiles * kTiles);
+    for (int t = 0; t < kTiles * kTiles; ++t) order[t] = t;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return rootScores[a] > rootScores[b]; });
+
+    for (int d = 0; d < count && d < kTiles * kTiles; ++d) {
+        if (rootScores[order[d]] <= 0.0f) break;
+
+        double cx, cy;
+        double zoom = static_cast<double>(startZoom) * kTiles;
+        tileCenter(order[d], startX, startY, startZoom, cx, cy);
+        ExplorerTarget best = { float(cx), float(cy), float(zoom), iterationsFor(zoom), rootScores[order[d]] };
+
+        // Descenso voraz: siempre hacia el tile con mejor puntuación
+        for (int level = 1; level < levels; ++level) {
+            const double magnitude = std::max(1.0, std::sqrt(cx * cx + cy * cy));
+            if (1.0 / (zoom * kTiles) < kPrecisionLimit * magnitude) break;
+
+            const int maxIterations = iterationsFor(zoom);
+            std::vector<float> scores = scoreAll(probe(cx, cy, zoom, gx, gy, maxIterations), maxIterations);
+            const int t = static_cast<int>(std::max_element(scores.begin(), scores.end()) - scores.begin());
+            if (scores[t] <= 0.0f) break;
+
+            tileCenter(t, cx, cy, zoom, cx, cy);
+            zoom *= kTiles;
+            if (scores[t] >= best.score) {
+                best = { float(cx), float(cy), float(zoom), iterationsFor(zoom), scores[t] };
+            }
+        }
+
+        if (nucleusSearch && !julia) {
+            double nx = best.moveX;
+            double ny = best.moveY;
+            if (findNucleus(nx, ny, best.maxIterations, 0.5 * std::min(width, height) / best.zoom)) {
+                best.moveX = float(nx);
+                best.moveY = float(ny);
+            }
+        }
+        targets.push_back(best);
+    }
+
+    std::sort(targets.begin(), targets.end(),
+        [](const ExplorerTarget& a, const ExplorerTarget& b) { return a.score > b.score; });
+    return targets;
+}
+
+std::vector<int> FractalExplorer::probe(double cx, double cy, double zoom, int gx, int gy, int maxIterations) {
+    std::vector<int> counts(gx * gy);
+    const double spanX = width / zoom;
+    const double spanY = height / zoom;
+
+    for (int j = 0; j < gy; ++j) {
+        const double imag = cy + ((j + 0.5) / gy - 0.5) * spanY;
+        for (int i = 0; i < gx; ++i) {
+            const double real = cx + ((i + 0.5) / gx - 0.5) * spanX;
+
+            // Mandelbrot: z0 = 0, c = punto. Julia: z0 = punto, c constante
+            double zr = julia ? real : 0.0;
+            double zi = julia ? imag : 0.0;
+            const double kr = julia ? c_re : real;
+            const double ki = julia ? c_im : imag;
+
+            int iterations = 0;
+            while (zr * zr + zi * zi <= 4.0 && iterations < maxIterations) {
+                const double t = zr * zr - zi * zi + kr;
+                zi = 2.0 * zr * zi + ki;
+                zr = t;
+                ++iterations;
+            }
+            counts[j * gx + i] = iterations;
+        }
+    }
+    probeSamples += static_cast<long long>(gx) * gy;
+    return counts;
+}
+
+float FractalExplorer::scoreTile(const std::vector<int>& counts, int gx, int x0, int y0, int tw, int th, int maxIterations) {
+    // Entropía del histograma de iteraciones (escala logarítmica, los puntos interiores aparte)
+    int histogram[kBins] = { 0 };
+    const double logMax = std::log1p(static_cast<double>(maxIterations));
+    for (int y = y0; y < y0 + th; ++y) {
+        for (int x = x0; x < x0 + tw; ++x) {
+            const int it = counts[y * gx + x];
+            const int bin = it >= maxIterations ? kBins - 1
+                : std::min(kBins - 2, static_cast<int>((kBins - 1) * std::log1p(static_cast<double>(it)) / logMax));
+            ++histogram[bin];
+        }
+    }
+    const double samples = static_cast<double>(tw) * th;
+    double entropy = 0.0;
+    for (int b = 0; b < kBins; ++b) {
+        if (histogram[b] == 0) continue;
+        const double p = histogram[b] / samples;
+        entropy -= p * std::log(p);
+    }
+    entropy /= std::log(static_cast<double>(kBins));
+
+    // Densidad de frontera: vecinos que no coinciden en escapar o con saltos grandes de iteraciones
+    auto differs = [maxIterations](int a, int b) {
+        if ((a >= maxIterations) != (b >= maxIterations)) return true;
+        return std::abs(a - b) > std::max(2, std::min(a, b) / 10);
+    };
+    int pairs = 0;
+    int boundary = 0;
+    for (int y = y0; y < y0 + th; ++y) {
+        for (int x = x0; x < x0 + tw; ++x) {
+            const int it = counts[y * gx + x];
+            if (x + 1 < x0 + tw) { ++pairs; boundary += differs(it, counts[y * gx + x + 1]); }
+            if (y + 1 < y0 + th) { ++pairs; boundary += differs(it, counts[(y + 1) * gx + x]); }
+        }
+    }
+    const double density = pairs > 0 ? static_cast<double>(boundary) / pairs : 0.0;
+
+    return static_cast<float>(entropy * (0.25 + density));
+}
+
+bool FractalExplorer::findNucleus(double& cx, double& cy, int maxIterations, double radius) {
+    // Periodo: iteración en la que la órbita pasa más cerca de 0 antes de escapar
+    int period = 0;
+    double zr = 0.0, zi = 0.0;
+    double closest = 1e300;
+    for (int n = 1; n <= maxIterations; ++n) {
+        const double t = zr * zr - zi * zi + cx;
+        zi = 2.0 * zr * zi + cy;
+        zr = t;
+        const double m = zr * zr + zi * zi;
+        if (m > 4.0) break;
+        if (m < closest) {
+            closest = m;
+            period = n;
+        }
+    }
+    if (period == 0) return false;
+
+    // Newton sobre f(c) = z_p(c), con dz/dc = 2 z dz/dc + 1
+    double ncx = cx, ncy = cy;
+    for (int step = 0; step < 64; ++step) {
+        double ar = 0.0, ai = 0.0; // z
+        double dr = 0.0, di = 0.0; // dz/dc
+        for (int n = 0; n < period; ++n) {
+            const double tdr = 2.0 * (ar * dr - ai * di) + 1.0;
+            di = 2.0 * (ar * di + ai * dr);
+            dr = tdr;
+            const double t = ar * ar - ai * ai + ncx;
+            ai = 2.0 * ar * ai + ncy;
+            ar = t;
+        }
+        const double den = dr * dr + di * di;
+        if (den == 0.0) return false;
+        const double sr = (ar * dr + ai * di) / den;
+        const double si = (ai * dr - ar * di) / den;
+        ncx -= sr;
+        ncy -= si;
+        if (!std::isfinite(ncx) || !std::isfinite(ncy)) return false;
+        if (sr * sr + si * si < 1e-24) break;
+    }
+
+    const double dx = ncx - cx;
+    const double dy = ncy - cy;
+    if (dx * dx + dy * dy > radius * radius) return false;
+    cx = ncx;
+    cy = ncy;
+    return true;
+}
+
+void FractalExplorer::setJulia(float c_real, float c_imag) {
+    julia = true;
+    c_re = c_real;
+    c_im = c_imag;
+}
+
+void FractalExplorer::setMandelbrot() {
+    julia = false;
+}
+
+void FractalExplorer::setStart(float zoom, float moveX, float moveY) {
+    startZoom = zoom;
+    startX = moveX;
+    startY = moveY;
+}
+
+void FractalExplorer::setDepth(int levels) {
+    depth = levels < 1 ? 1 : levels;
+}
+
+void FractalExplorer::setNucleusSearch(bool enabled) {
+    nucleusSearch = enabled;
+}
@@ -0,0 +1,282 @@
+#include "../include/fft.hpp"
+#include "../include/parallel.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+using cplx = std::complex<float>;
+
+// Prime factors above this size use Bluestein instead of an O(p^2) butterfly
+constexpr int kMaxRadix = 37;
+// Columns gathered together, so that each spectrum row is read in contiguous runs
+constexpr unsigned int kColumnBlock = 16;
+// Transformed values per thread below which the 2D transform is not split
+constexpr unsigned int kParallelGrain = 1u << 16;
+
+// exp(-2 pi i k / n), computed in double precision
+cplx twiddle(double k, double n) {
+    const double a = -2.0 * 3.14159265358979323846 * k / n;
+    return cplx(static_cast<float>(std::cos(a)), static_cast<float>(std::sin(a)));
+}
+
+// Plain complex product: operator* also handles infinities and NaNs through a library call
+inline cplx mul(cplx a, cplx b) {
+    return cplx(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+void conjugate(cplx* data, unsigned int n) {
+    for (unsigned int i = 0; i < n; i++) {
+        data[i] = std::conj(data[i]);
+    }
+}
+
+}
+
+FFT::FFT(unsigned int size) : n(std::max(size, 1u))
+{
+    // Radix 4 first (fewest multiplies), then 2, then the odd primes (3 and 5 have their own butterflies)
+    unsigned int rest = n;
+    while (rest % 4 == 0) { radices.push_back(4); rest /= 4; }
+    while (rest % 2 == 0) { radices.push_back(2); rest /= 2; }
+    for (unsigned int p = 3; p * p <= rest; p += 2) {
+        while (rest % p == 0) { radices.push_back(p); rest /= p; }
+    }
+    if (rest > 1) radices.push_back(rest);
+
+    if (radices.empty() || radices.back() <= kMaxRadix) {
+        twiddles.resize(n);
+        for (unsigned int k = 0; k < n; k++) {
+            twiddles[k] = twiddle(k, n);
+        }
+        return;
+    }
+
+    // Bluestein: jk = (j^2 + k^2 - (k - j)^2) / 2 turns the transform into a convolution with
+    // the chirp exp(pi i k^2 / n), done with a power-of-two transform of at least 2n - 1 values
+    radices.clear();
+    unsigned int m = 1;
+    while (m < 2 * n - 1) m *= 2;
+    convolution = std::make_shared<const FFT>(m);
+    chirp.resize(n);
+    for (unsigned int k = 0; k < n; k++) {
+        // k^2 modulo 2n keeps the angle accurate for large k
+        const unsigned long long k2 = static_cast<unsigned long long>(k) * k % (2ull * n);
+        chirp[k] = twiddle(k2 * 0.5, n);
+    }
+    chirpSpectrum.assign(m, cplx(0.0f, 0.0f));
+    chirpSpectrum[0] = std::conj(chirp[0]);
+    for (unsigned int k = 1; k < n; k++) {
+        chirpSpectrum[k] = chirpSpectrum[m - k] = std::conj(chirp[k]);
+    }
+    std::vector<cplx> work(convolution->workSize());
+    convolution->forward(chirpSpectrum.data(), work.data());
+    for (cplx& c : chirpSpectrum) {
+        c /= static_cast<float>(m);
+    }
+}
+
+std::size_t FFT::workSize() const
+{
+    return convolution ? convolution->size() + convolution->workSize() : n;
+}
+
+void FFT::forward(cplx* data, cplx* work) const
+{
+    if (n == 1) return;
+    if (convolution) {
+        bluestein(data, work);
+        return;
+    }
+    std::copy(data, data + n, work);
+    mixedRadix(data, work, 1, 0, n);
+}
+
+void FFT::inverse(cplx* data, cplx* work) const
+{
+    // conj(F(conj(x))) is the unnormalized inverse
+    conjugate(data, n);
+    forward(data, work);
+    conjugate(data, n);
+}
+
+void FFT::mixedRadix(cplx* out, const cplx* in, std::size_t stride, std::size_t factor, unsigned int length) const
+{
+    const unsigned int p = radices[factor];
+    const unsigned int m = length / p;
+    // Decimation in time: the p interleaved subsequences are transformed into consecutive blocks
+    if (m == 1) {
+        for (unsigned int q = 0; q < p; q++) {
+            out[q] = in[q * stride];
+        }
+    } else {
+        for (unsigned int q = 0; q < p; q++) {
+            mixedRadix(out + q * m, in + q * stride, stride * p, factor + 1, m);
+        }
+    }
+
+    // Butterflies combining the blocks; the twiddles of length `length` are every
+    // `stride`-th twiddle of the full table
+    const cplx* tw = twiddles.data();
+    if (p == 2) {
+        for (unsigned int u = 0; u < m; u++) {
+            const cplx t = mul(out[u + m], tw[u * stride]);
+            out[u + m] = out[u] - t;
+            out[u] += t;
+        }
+    } else if (p == 4) {
+        for (unsigned int u = 0; u < m; u++) {
+            const cplx s0 = mul(out[u + m], tw[u * stride]);
+            const cplx s1 = mul(out[u + 2 * m], tw[2 * u * stride]);
+            const cplx s2 = mul(out[u + 3 * m], tw[3 * u * stride]);
+            const cplx s5 = out[u] - s1;
+            const cplx s4 = s0 - s2;
+            const cplx s3 = s0 + s2;
+            const cplx a = out[u] + s1;
+            out[u] = a + s3;
+            out[u + 2 * m] = a - s3;
+            // -i * s4 and +i * s4
+            out[u + m] = cplx(s5.real() + s4.imag(), s5.imag() - s4.real());
+            out[u + 3 * m] = cplx(s5.real() - s4.imag(), s5.imag() + s4.real());
+        }
+    } else if (p == 3) {
+        const float sin3 = tw[stride * m].imag(); // -sin(2 pi / 3)
+        for (unsigned int u = 0; u < m; u++) {
+            const cplx s1 = mul(out[u + m], tw[u * stride]);
+            const cplx s2 = mul(out[u + 2 * m], tw[2 * u * stride]);
+            const cplx s3 = s1 + s2;
+            const cplx s0 = (s1 - s2) * sin3;
+            const cplx a = out[u] - s3 * 0.5f;
+            out[u] += s3;
+            out[u + m] = cplx(a.real() - s0.imag(), a.imag() + s0.real());
+            out[u + 2 * m] = cplx(a.real() + s0.imag(), a.imag() - s0.real());
+        }
+    } else if (p == 5) {
+        const cplx ya = tw[stride * m];     // exp(-2 pi i / 5)
+        const cplx yb = tw[2 * stride * m]; // exp(-4 pi i / 5)
+        for (unsigned int u = 0; u < m; u++) {
+            const cplx s0 = out[u];
+            const cplx s1 = mul(out[u + m], tw[u * stride]);
+            const cplx s2 = mul(out[u + 2 * m], tw[2 * u * stride]);
+            const cplx s3 = mul(out[u + 3 * m], tw[3 * u * stride]);
+            const cplx s4 = mul(out[u + 4 * m], tw[4 * u * stride]);
+            const cplx s7 = s1 + s4, s10 = s1 - s4;
+            const cplx s8 = s2 + s3, s9 = s2 - s3;
+            out[u] = s0 + s7 + s8;
+            const cplx s5 = s0 + s7 * ya.real() + s8 * yb.real();
+            const cplx s6(s10.imag() * ya.imag() + s9.imag() * yb.imag(), -s10.real() * ya.imag() - s9.real() * yb.imag());
+            out[u + m] = s5 - s6;
+            out[u + 4 * m] = s5 + s6;
+            const cplx s11 = s0 + s7 * yb.real() + s8 * ya.real();
+            const cplx s12(-s10.imag() * yb.imag() + s9.imag() * ya.imag(), s10.real() * yb.imag() - s9.real() * ya.imag());
+            out[u + 2 * m] = s11 + s12;
+            out[u + 3 * m] = s11 - s12;
+        }
+    } else {
+        cplx scratch[kMaxRadix];
+        for (unsigned int u = 0; u < m; u++) {
+            for (unsigned int q = 0; q < p; q++) {
+                scratch[q] = out[u + q * m];
+            }
+            for (unsigned int q1 = 0; q1 < p; q1++) {
+                const std::size_t k = u + q1 * m;
+                std::size_t index = 0;
+                cplx sum = scratch[0];
+                for (unsigned int q = 1; q < p; q++) {
+                    index += stride * k;
+                    if (index >= n) index -= n;
+                    sum += mul(scratch[q], tw[index]);
+                }
+                out[k] = sum;
+            }
+        }
+    }
+}
+
+void FFT::bluestein(cplx* data, cplx* work) const
+{
+    const unsigned int m = convolution->size();
+    cplx* a = work;
+    for (unsigned int k = 0; k < n; k++) {
+        a[k] = mul(data[k], chirp[k]);
+    }
+    std::fill(a + n, a + m, cplx(0.0f, 0.0f));
+    convolution->forward(a, work + m);
+    for (unsigned int k = 0; k < m; k++) {
+        a[k] = mul(a[k], chirpSpectrum[k]);
+    }
+    convolution->inverse(a, work + m);
+    for (unsigned int k = 0; k < n; k++) {
+        data[k] = mul(a[k], chirp[k]);
+    }
+}
+
+void inverseRealFFT2D(std::vector<cplx>& spectrum, unsigned int width, unsigned int height, float* out)
+{
+    const unsigned int bins = width / 2 + 1;
+    const bool packed = width % 2 == 0;
+
+    // Columns, in blocks gathered row by row
+    const FFT columns(height);
+    const unsigned int blocks = (bins + kColumnBlock - 1) / kColumnBlock;
+    parallelFor(0, blocks, kParallelGrain / (height * kColumnBlock) + 1, [&](unsigned int first, unsigned int last) {
+        std::vector<cplx> block(static_cast<std::size_t>(kColumnBlock) * height), work(columns.workSize());
+        for (unsigned int b = first; b < last; b++) {
+            const unsigned int c0 = b * kColumnBlock;
+            const unsigned int count = std::min(kColumnBlock, bins - c0);
+            for (unsigned int y = 0; y < height; y++) {
+                for (unsigned int c = 0; c < count; c++) {
+                    block[c * height + y] = spectrum[static_cast<std::size_t>(y) * bins + c0 + c];
+                }
+            }
+            for (unsigned int c = 0; c < count; c++) {
+                columns.inverse(&block[c * height], work.data());
+            }
+            for (unsigned int y = 0; y < height; y++) {
+                for (unsigned int c = 0; c < count; c++) {
+                    spectrum[static_cast<std::size_t>(y) * bins + c0 + c] = block[c * height + y];
+                }
+            }
+        }
+    });
+
+    // Rows. An even row of length 2M is computed as the complex transform of length M of
+    // z[j] = x[2j] + i x[2j + 1]: Z[k] = E[k] + i O[k], with E[k] = X[k] + conj(X[M - k]) and
+    // O[k] = (X[k] - conj(X[M - k])) exp(2 pi i k / 2M).
+    const unsigned int half = width / 2;
+    const FFT rows(packed ? half : width);
+    std::vector<cplx> rotation(packed ? half : 0);
+    for (unsigned int k = 0; k < rotation.size(); k++) {
+        rotation[k] = std::conj(twiddle(k, width));
+    }
+    parallelFor(0, height, kParallelGrain / width + 1, [&](unsigned int first, unsigned int last) {
+        std::vector<cplx> row(rows.size()), work(rows.workSize());
+        for (unsigned int y = first; y < last; y++) {
+            const cplx* X = &spectrum[static_cast<std::size_t>(y) * bins];
+            float* line = out + static_cast<std::size_t>(y) * width;
+            if (packed) {
+                for (unsigned int k = 0; k < half; k++) {
+                    const cplx mirror = std::conj(X[half - k]);
+                    const cplx e = X[k] + mirror;
+                    const cplx o = mul(X[k] - mirror, rotation[k]);
+                    row[k] = cplx(e.real() - o.imag(), e.imag() + o.real());
+                }
+                rows.inverse(row.data(), work.data());
+                for (unsigned int j = 0; j < half; j++) {
+                    line[2 * j] = row[j].real();
+                    line[2 * j + 1] = row[j].imag();
+                }
+            } else {
+                row[0] = X[0];
+                for (unsigned int k = 1; k < bins; k++) {
+                    row[k] = X[k];
+                    row[width - k] = std::conj(X[k]);
+                }
+                rows.inverse(row.data(), work.data());
+                for (unsigned int x = 0; x < width; x++) {
+                    line[x] = row[x].real();
+                }
+            }
+        }
+    });
+}
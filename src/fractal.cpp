@@ -6,6 +6,17 @@
 #include <filesystem>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+
+namespace {
+
+// Límite de iteraciones para una región renderizada con menos detalle
+int scaledIterations(int maxIterations, float detail) {
+    if (detail >= 1.0f) return maxIterations;
+    return std::max(1, static_cast<int>(maxIterations * detail));
+}
+
+}
 
 Mandelbrot::Mandelbrot(unsigned int w, unsigned int h, float zoom, float moveX, float moveY, int maxIterations)
     : width(w), height(h), zoom(zoom), moveX(moveX), moveY(moveY), maxIterations(maxIterations) 
@@ -26,36 +37,39 @@ std::vector<unsigned char> Mandelbrot::generateImage(std::string &imageName) {
 
 std::vector<unsigned char> Mandelbrot::generateMandelbrotImage() {
     std::vector<unsigned char> image(width * height * 4); // 4 canales: RGBA
+    renderRegion(image, 0, 0, width, height);
+    return image;
+}
 
-    for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
+void Mandelbrot::renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, float detail) {
+    const int iterationLimit = scaledIterations(maxIterations, detail);
+
+    for (unsigned int y = y0; y < y1; y += step) {
+        for (unsigned int x = x0; x < x1; x += step) {
             float real = (x - width / 2.0f) / zoom + moveX;
             float imag = (y - height / 2.0f) / zoom + moveY;
             std::complex<float> c(real, imag);
             std::complex<float> z(0, 0);
             int iterations = 0;
 
-            while (std::abs(z) <= scapeRadius && iterations < maxIterations) {
+            while (std::abs(z) <= scapeRadius && iterations < iterationLimit) {
                 z = z * z + c;
                 ++iterations;
             }
 
             // Color basado en el número de iteraciones
-            unsigned char color = static_cast<unsigned char>(255 * float(iterations) / maxIterations);
+            unsigned char color = static_cast<unsigned char>(255 * float(iterations) / iterationLimit);
 
             // Colorear de forma suave (gradientes en los canales RGB)
             unsigned char r = static_cast<unsigned char>(color * sat_r);
             unsigned char g = static_cast<unsigned char>(color * sat_g); // Menos saturación de verde
             unsigned char b = static_cast<unsigned char>(color * sat_b); // Menos saturación de azul
 
-            image[(y * width + x) * 4] = r;   // R
-            image[(y * width + x) * 4 + 1] = g; // G
-            image[(y * width + x) * 4 + 2] = b; // B
-            image[(y * width + x) * 4 + 3] = 255; // A (opacidad)
+            // Cada muestra cubre un bloque de step x step píxeles
+            fillBlock(image, width, x, y, std::min(step, x1 - x), std::min(step, y1 - y), r, g, b, 255);
         }
     }
-
-    return image;
 }
 
 // Métodos para ajustar los parámetros
@@ -117,36 +131,39 @@ std::vector<unsigned char> JuliaSet::generateImage(std::string &imageName) {
 // Generar los datos de la imagen del conjunto de Julia
 std::vector<unsigned char> JuliaSet::generateJuliaSetImage() {
     std::vector<unsigned char> image(width * height * 4); // 4 canales: RGBA
+    renderRegion(image, 0, 0, width, height);
+    return image;
+}
+
+void JuliaSet::renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, float detail) {
+    const int iterationLimit = scaledIterations(maxIterations, detail);
 
-    for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
+    for (unsigned int y = y0; y < y1; y += step) {
+        for (unsigned int x = x0; x < x1; x += step) {
             // Convertir coordenadas de píxeles a coordenadas del plano complejo
             float real = (x - width / 2.0f) / zoom + moveX;
             float imag = (y - height / 2.0f) / zoom + moveY;
             std::complex<float> z(real, imag);
 
             int iterations = 0;
-            while (std::abs(z) <= scapeRadius && iterations < maxIterations) {
+            while (std::abs(z) <= scapeRadius && iterations < iterationLimit) {
                 z = z * z + c;  // Ecuación del conjunto de Julia
                 ++iterations;
             }
 
             // Color basado en el número de iteraciones
-            unsigned char color = static_cast<unsigned char>(255 * float(iterations) / maxIterations);
+            unsigned char color = static_cast<unsigned char>(255 * float(iterations) / iterationLimit);
 
             // Colorear de forma suave (gradientes en los canales RGB)
             unsigned char r = static_cast<unsigned char>(color * sat_r);
             unsigned char g = static_cast<unsigned char>(color * sat_g);
             unsigned char b = static_cast<unsigned char>(color * sat_b);
 
-            image[(y * width + x) * 4] = r;   // R
-            image[(y * width + x) * 4 + 1] = g; // G
-            image[(y * width + x) * 4 + 2] = b; // B
-            image[(y * width + x) * 4 + 3] = 255; // A (opacidad)
+            // Cada muestra cubre un bloque de step x step píxeles
+            fillBlock(image, width, x, y, std::min(step, x1 - x), std::min(step, y1 - y), r, g, b, 255);
         }
     }
-
-    return image;
 }
 
 // Métodos para ajustar parámetros
@@ -192,11 +209,159 @@ void JuliaSet::setScapeRadius(float r)
  
 }
 
+namespace {
+
+// Un paso de la iteración para f(z) = z^3 - 1, resuelto en tiempo de compilación.
+// Se escribe con partes real e imaginaria separadas para que el mismo código sirva
+// en float y en double, y para que el compilador lo pueda vectorizar por carriles.
+template <NewtonMethod M, typename T>
+inline void newtonStep(T zr, T zi, T relaxation, T& nr, T& ni) {
+    const T z2r = zr * zr - zi * zi;          // z^2
+    const T z2i = T(2) * zr * zi;
+    const T fr = z2r * zr - z2i * zi - T(1);  // f(z)  = z^3 - 1
+    const T fi = z2r * zi + z2i * zr;
+    const T dr = T(3) * z2r;                  // f'(z) = 3z^2
+    const T di = T(3) * z2i;
+
+    T numr, numi, denr, deni;
+    if constexpr (M == NewtonMethod::Newton || M == NewtonMethod::Relaxed) {
+        numr = fr; numi = fi;
+        denr = dr; deni = di;
+    } else {
+        const T d2r = T(6) * zr;              // f''(z) = 6z
+        const T d2i = T(6) * zi;
+        const T k = (M == NewtonMethod::Halley) ? T(2) : T(1);
+        // Halley:   2ff' / (2f'^2 - ff'')
+        // Schroder:  ff' /  (f'^2 - ff'')
+        numr = k * (fr * dr - fi * di);
+        numi = k * (fr * di + fi * dr);
+        denr = k * (dr * dr - di * di) - (fr * d2r - fi * d2i);
+        deni = k * (T(2) * dr * di) - (fr * d2i + fi * d2r);
+    }
+
+    const T inv = T(1) / (denr * denr + deni * deni);
+    T qr = (numr * denr + numi * deni) * inv;
+    T qi = (numi * denr - numr * deni) * inv;
+    if constexpr (M == NewtonMethod::Relaxed) {
+        qr *= relaxation;
+        qi *= relaxation;
+    }
+    nr = zr - qr;
+    ni = zi - qi;
+}
+
+// Tolerancia de convergencia
+constexpr double kNewtonTolerance = 1e-6;
+
+// Iteración completa en double a partir de z, continuando desde `iterations`
+template <NewtonMethod M>
+inline int newtonIterations(double zr, double zi, int iterations, int maxIterations, double relaxation) {
+    const double tol2 = kNewtonTolerance * kNewtonTolerance;
+    while (iterations < maxIterations) {
+        double nr, ni;
+        newtonStep<M>(zr, zi, relaxation, nr, ni);
+
+        // Verificar la convergencia
+        const double dr = nr - zr;
+        const double di = ni - zi;
+        if (dr * dr + di * di < tol2) {
+            break;
+        }
+
+        zr = nr;  // Actualizar z
+        zi = ni;
+        ++iterations;
+    }
+    return iterations;
+}
+
+// Radio alrededor de cada raíz a partir del cual se pasa de float a double.
+// Lejos de las raíces la precisión de float basta para seguir la trayectoria.
+constexpr float kCoarseRadius = 1e-3f;
+// Iteraciones en float antes de considerar caótica la trayectoria. En las fronteras
+// entre cuencas el redondeo de float cambia el resultado, así que esos píxeles se
+// repiten desde el principio en double.
+constexpr int kFloatBudget = 16;
+// Las iteraciones muy grandes se desbordan en float, se terminan en double
+constexpr float kFloatGuard = 1e12f;
+// Carriles de float por bloque (un registro AVX)
+constexpr int kNewtonLanes = 8;
+
+// Raíces de z^3 - 1
+constexpr float kRootIm = 0.86602540378443864676f;
+
+// Iteración de precisión mixta de una fila: todos los carriles avanzan en float
+// hasta quedar cerca de una raíz, y sólo entonces se termina cada píxel en double.
+// Con todo, el resultado coincide con el kernel en double a una iteración o menos.
+template <NewtonMethod M>
+void newtonRowMixed(const float* real, float imag, unsigned int count, int maxIterations, float relaxation, int* out) {
+    const float tol2 = static_cast<float>(kNewtonTolerance * kNewtonTolerance);
+    const float coarse2 = kCoarseRadius * kCoarseRadius;
+
+    for (unsigned int x0 = 0; x0 < count; x0 += kNewtonLanes) {
+        float zr[kNewtonLanes], zi[kNewtonLanes];
+        int iterations[kNewtonLanes];
+        int active[kNewtonLanes];
+
+        for (int l = 0; l < kNewtonLanes; ++l) {
+            const bool inside = x0 + l < count;
+            zr[l] = inside ? real[x0 + l] : 0.0f;
+            zi[l] = imag;
+            iterations[l] = 0;
+            active[l] = inside ? 1 : 0;
+        }
+
+        const int floatIterations = maxIterations < kFloatBudget ? maxIterations : kFloatBudget;
+        for (int it = 0; it < floatIterations; ++it) {
+            int anyActive = 0;
+            for (int l = 0; l < kNewtonLanes; ++l) {
+                float nr, ni;
+                newtonStep<M>(zr[l], zi[l], relaxation, nr, ni);
+
+                const float dr = nr - zr[l];
+                const float di = ni - zi[l];
+                // La comprobación final de convergencia siempre se hace en double
+                // Sin ramas (| y & en lugar de || y &&) para que el bucle se vectorice
+                const int stopBefore = int(dr * dr + di * di < tol2) | int(nr * nr + ni * ni > kFloatGuard);
+                const int advance = active[l] & (stopBefore ^ 1);
+
+                const float r0 = (nr - 1.0f) * (nr - 1.0f) + ni * ni;
+                const float r1 = (nr + 0.5f) * (nr + 0.5f) + (ni - kRootIm) * (ni - kRootIm);
+                const float r2 = (nr + 0.5f) * (nr + 0.5f) + (ni + kRootIm) * (ni + kRootIm);
+                const int nearRoot = int(r0 < coarse2) | int(r1 < coarse2) | int(r2 < coarse2);
+
+                zr[l] = advance ? nr : zr[l];
+                zi[l] = advance ? ni : zi[l];
+                iterations[l] += advance;
+                active[l] = advance & (nearRoot ^ 1);
+                anyActive |= active[l];
+            }
+            if (!anyActive) {
+                break;
+            }
+        }
+
+        for (int l = 0; l < kNewtonLanes && x0 + l < count; ++l) {
+            if (active[l]) {
+                // Trayectoria caótica: se repite entera en double
+                out[x0 + l] = newtonIterations<M>(real[x0 + l], imag, 0, maxIterations, relaxation);
+            } else {
+                out[x0 + l] = newtonIterations<M>(zr[l], zi[l], iterations[l], maxIterations, relaxation);
+            }
+        }
+    }
+}
+
+}
+
 Newton::Newton(unsigned int w, unsigned int h, float zoom, float moveX, float moveY, int maxIter, float tol)
         : width(w), height(h), zoom(zoom), moveX(moveX), moveY(moveY), maxIterations(maxIter), tolerance(tol) {
         sat_r = 1.0f;
         sat_g = 0.7f;
         sat_b = 0.5f;
+        method = NewtonMethod::Newton;
+        relaxation = 0.8f;
+        mixedPrecision = false;
 }
 
 std::vector<unsigned char> Newton::generateImage(std::string& imageName)
@@ -208,50 +373,68 @@ std::vector<unsigned char> Newton::generateImage(std::string& imageName)
 
 std::vector<unsigned char> Newton::generateNewtonImage() {
     std::vector<unsigned char> image(width * height * 4); // 4 canales: RGBA
+    renderRegion(image, 0, 0, width, height);
+    return image;
+}
 
-    // Para cada píxel de la imagen
-    for (unsigned int y = 0; y < height; ++y) {
-        for (unsigned int x = 0; x < width; ++x) {
-            // Convertir las coordenadas a un espacio complejo
-            float real = (x - width / 2.0f) / zoom + moveX;
-            float imag = (y - height / 2.0f) / zoom + moveY;
-            std::complex<double> z(real, imag);
+void Newton::renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, float detail) {
+    const int iterationLimit = scaledIterations(maxIterations, detail);
+
+    // El esquema se elige una sola vez por región, no dentro del bucle
+    switch (method) {
+    case NewtonMethod::Halley:
+        renderNewton<NewtonMethod::Halley>(image, x0, y0, x1, y1, step, iterationLimit);
+        break;
+    case NewtonMethod::Schroder:
+        renderNewton<NewtonMethod::Schroder>(image, x0, y0, x1, y1, step, iterationLimit);
+        break;
+    case NewtonMethod::Relaxed:
+        renderNewton<NewtonMethod::Relaxed>(image, x0, y0, x1, y1, step, iterationLimit);
+        break;
+    case NewtonMethod::Newton:
+    default:
+        renderNewton<NewtonMethod::Newton>(image, x0, y0, x1, y1, step, iterationLimit);
+        break;
+    }
+}
 
-            int iterations = 0;
-            //const int maxIterations = 100;  // Número máximo de iteraciones para el método de Newton
-            double tolerance = 1e-6;  // Tolerancia de convergencia
-
-            // Iteración de Newton
-            while (iterations < maxIterations) {
-                // f(z) = z^3 - 1
-                std::complex<double> fz = std::pow(z, 3) - std::complex<double>(1.0);
-                std::complex<double> fz_prime = 3.0 * std::pow(z, 2); // Derivada de f(z): 3z^2
-                std::complex<double> z_new = z - fz / fz_prime;
-
-                // Verificar la convergencia
-                if (std::abs(z_new - z) < tolerance) {
-                    break;
-                }
-
-                z = z_new;  // Actualizar z
-                ++iterations;
+template <NewtonMethod M>
+void Newton::renderNewton(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, int iterationLimit) {
+    const unsigned int samples = (x1 - x0 + step - 1) / step;
+    std::vector<float> real(samples);
+    std::vector<int> iterations(samples);
+
+    // Convertir las coordenadas de la fila a un espacio complejo
+    for (unsigned int i = 0; i < samples; ++i) {
+        real[i] = (x0 + i * step - width / 2.0f) / zoom + moveX;
+    }
+
+    for (unsigned int y = y0; y < y1; y += step) {
+        float imag = (y - height / 2.0f) / zoom + moveY;
+
+        if (mixedPrecision) {
+            newtonRowMixed<M>(real.data(), imag, samples, iterationLimit, relaxation, iterations.data());
+        } else {
+            for (unsigned int i = 0; i < samples; ++i) {
+                iterations[i] = newtonIterations<M>(real[i], imag, 0, iterationLimit, relaxation);
             }
+        }
+
+        for (unsigned int i = 0; i < samples; ++i) {
+            const unsigned int x = x0 + i * step;
 
             // Mapear el número de iteraciones a un valor de color
-            unsigned char color = static_cast<unsigned char>(255 * float(iterations) / maxIterations);
+            unsigned char color = static_cast<unsigned char>(255 * float(iterations[i]) / iterationLimit);
 
             // Colorear la imagen con una saturación específica
             unsigned char r = static_cast<unsigned char>(color * sat_r);
             unsigned char g = static_cast<unsigned char>(color * sat_g);
             unsigned char b = static_cast<unsigned char>(color * sat_b);
 
-            // Asignar los valores a la imagen
-            image[(y * width + x) * 4] = r;   // R
-            image[(y * width + x) * 4 + 1] = g; // G
-            image[(y * width + x) * 4 + 2] = b; // B
-            image[(y * width + x) * 4 + 3] = 255; // A (opacidad)
+            // Cada muestra cubre un bloque de step x step píxeles
+            fillBlock(image, width, x, y, std::min(step, x1 - x), std::min(step, y1 - y), r, g, b, 255);
         }
     }
-
-    return image;
 }
@@ -0,0 +1,431 @@
+#include "../include/hashlife.hpp"
+#include "../include/bits.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr unsigned int kLeafLevel = 3;
+constexpr unsigned int kMinRootLevel = 5;
+constexpr unsigned int kMaxLevel = 62;
+
+// splitmix64 finalizer
+inline std::uint64_t mix(std::uint64_t h) {
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+inline std::uint64_t hashChildren(std::uint32_t nw, std::uint32_t ne, std::uint32_t sw, std::uint32_t se) {
+    return mix(((std::uint64_t(nw) << 32) | ne) ^ mix((std::uint64_t(sw) << 32) | se));
+}
+
+inline std::uint64_t hashLeaf(std::uint64_t bits) {
+    return mix(bits ^ 0x9e3779b97f4a7c15ull);
+}
+
+inline std::uint64_t saturatedAdd(std::uint64_t a, std::uint64_t b) {
+    return a + b < a ? std::numeric_limits<std::uint64_t>::max() : a + b;
+}
+
+// Row `y` of a leaf
+inline std::uint32_t leafRow(std::uint64_t bits, unsigned int y) {
+    return static_cast<std::uint32_t>((bits >> (8 * y)) & 0xff);
+}
+
+// One generation of a 16x16 block, one row per entry. Cells outside the block count as dead,
+// so the outer ring becomes invalid; the neighbours are added as in GameOfLife
+void stepBlock(std::uint32_t* rows) {
+    std::uint32_t t0[16], t1[16], s[16], c[16];
+    for (int y = 0; y < 16; y++) {
+        const std::uint32_t west = rows[y] << 1;
+        const std::uint32_t east = rows[y] >> 1;
+        s[y] = west ^ east;
+        c[y] = west & east;
+        t0[y] = s[y] ^ rows[y];
+        t1[y] = c[y] | (s[y] & rows[y]);
+    }
+    std::uint32_t next[16];
+    for (int y = 0; y < 16; y++) {
+        const std::uint32_t a0 = y > 0 ? t0[y - 1] : 0, a1 = y > 0 ? t1[y - 1] : 0;
+        const std::uint32_t b0 = y < 15 ? t0[y + 1] : 0, b1 = y < 15 ? t1[y + 1] : 0;
+        const std::uint32_t x0 = a0 ^ b0 ^ s[y];
+        const std::uint32_t k = (a0 & b0) | (s[y] & (a0 ^ b0));
+        const std::uint32_t u = a1 ^ b1;
+        const std::uint32_t v = c[y] ^ k;
+        const std::uint32_t one = (u ^ v) & ~((a1 & b1) | (c[y] & k));
+        next[y] = one & (x0 | rows[y]) & 0xffff;
+    }
+    std::copy(next, next + 16, rows);
+}
+
+}
+
+HashLife::HashLife(std::size_t cap)
+    : nodes(1), buckets(std::size_t(1) << 16, 0), emptyNodes(kMaxLevel + 2, 0),
+      root(0), stepLog(0), generation(0), memoryCap(cap)
+{
+    root = empty(kMinRootLevel);
+}
+
+std::uint32_t HashLife::leaf(std::uint64_t bits) {
+    const std::size_t bucket = hashLeaf(bits) & (buckets.size() - 1);
+    for (std::uint32_t i = buckets[bucket]; i; i = nodes[i].next) {
+        if (nodes[i].level == kLeafLevel && nodes[i].bits == bits) return i;
+    }
+    Node n;
+    n.bits = bits;
+    n.population = popcount64(bits);
+    n.level = kLeafLevel;
+    n.next = buckets[bucket];
+    nodes.push_back(n);
+    const std::uint32_t index = static_cast<std::uint32_t>(nodes.size() - 1);
+    buckets[bucket] = index;
+    if (nodes.size() > buckets.size()) {
+        rehash(buckets.size() * 2);
+    }
+    return index;
+}
+
+std::uint32_t HashLife::join(std::uint32_t nw, std::uint32_t ne, std::uint32_t sw, std::uint32_t se) {
+    const std::size_t bucket = hashChildren(nw, ne, sw, se) & (buckets.size() - 1);
+    for (std::uint32_t i = buckets[bucket]; i; i = nodes[i].next) {
+        const Node& n = nodes[i];
+        if (n.level > kLeafLevel && n.nw == nw && n.ne == ne && n.sw == sw && n.se == se) return i;
+    }
+    Node n;
+    n.nw = nw;
+    n.ne = ne;
+    n.sw = sw;
+    n.se = se;
+    n.level = nodes[nw].level + 1;
+    n.population = saturatedAdd(saturatedAdd(nodes[nw].population, nodes[ne].population),
+        saturatedAdd(nodes[sw].population, nodes[se].population));
+    n.next = buckets[bucket];
+    nodes.push_back(n);
+    const std::uint32_t index = static_cast<std::uint32_t>(nodes.size() - 1);
+    buckets[bucket] = index;
+    if (nodes.size() > buckets.size()) {
+        rehash(buckets.size() * 2);
+    }
+    return index;
+}
+
+std::uint32_t HashLife::empty(unsigned int level) {
+    if (!emptyNodes[level]) {
+        if (level == kLeafLevel) {
+            emptyNodes[level] = leaf(0);
+        } else {
+            const std::uint32_t e = empty(level - 1);
+            emptyNodes[level] = join(e, e, e, e);
+        }
+    }
+    return emptyNodes[level];
+}
+
+void HashLife::rehash(std::size_t size) {
+    buckets.assign(size, 0);
+    for (std::uint32_t i = 1; i < nodes.size(); i++) {
+        Node& n = nodes[i];
+        const std::uint64_t h = n.level == kLeafLevel ? hashLeaf(n.bits) : hashChildren(n.nw, n.ne, n.sw, n.se);
+        const std::size_t bucket = h & (size - 1);
+        n.next = buckets[bucket];
+        buckets[bucket] = i;
+    }
+}
+
+std::uint32_t HashLife::center(std::uint32_t index) {
+    const Node n = nodes[index];
+    if (n.level == kLeafLevel + 1) {
+        // Rows 4 to 11 and columns 4 to 11 of the four leaves
+        std::uint64_t bits = 0;
+        for (unsigned int y = 0; y < 8; y++) {
+            const unsigned int row = y + 4;
+            const std::uint64_t left = nodes[row < 8 ? n.nw : n.sw].bits;
+            const std::uint64_t right = nodes[row < 8 ? n.ne : n.se].bits;
+            const std::uint32_t line = leafRow(left, row & 7) | (leafRow(right, row & 7) << 8);
+            bits |= std::uint64_t((line >> 4) & 0xff) << (8 * y);
+        }
+        return leaf(bits);
+    }
+    return join(nodes[n.nw].se, nodes[n.ne].sw, nodes[n.sw].ne, nodes[n.se].nw);
+}
+
+std::uint32_t HashLife::baseResult(std::uint32_t index) {
+    const Node n = nodes[index];
+    std::uint32_t rows[16];
+    for (unsigned int y = 0; y < 16; y++) {
+        const std::uint64_t left = nodes[y < 8 ? n.nw : n.sw].bits;
+        const std::uint64_t right = nodes[y < 8 ? n.ne : n.se].bits;
+        rows[y] = leafRow(left, y & 7) | (leafRow(right, y & 7) << 8);
+    }
+    const unsigned int generations = 1u << std::min(stepLog, 2u);
+    for (unsigned int g = 0; g < generations; g++) {
+        stepBlock(rows);
+    }
+    std::uint64_t bits = 0;
+    for (unsigned int y = 0; y < 8; y++) {
+        bits |= std::uint64_t((rows[y + 4] >> 4) & 0xff) << (8 * y);
+    }
+    return leaf(bits);
+}
+
+std::uint32_t HashLife::result(std::uint32_t index) {
+    if (nodes[index].result) return nodes[index].result;
+    const Node n = nodes[index];
+    std::uint32_t r;
+    if (n.population == 0) {
+        r = empty(n.level - 1);
+    } else if (n.level == kLeafLevel + 1) {
+        r = baseResult(index);
+    } else {
+        // Nine overlapping subnodes of half the side, then four of a quarter advanced from them
+        const Node nw = nodes[n.nw], ne = nodes[n.ne], sw = nodes[n.sw], se = nodes[n.se];
+        std::uint32_t sub[9] = {
+            n.nw, join(nw.ne, ne.nw, nw.se, ne.sw), n.ne,
+            join(nw.sw, nw.se, sw.nw, sw.ne), join(nw.se, ne.sw, sw.ne, se.nw), join(ne.sw, ne.se, se.nw, se.ne),
+            n.sw, join(sw.ne, se.nw, sw.se, se.sw), n.se
+        };
+        // At full speed both halves advance; a shorter step only advances the second one
+        const bool full = stepLog + 2 >= n.level;
+        for (std::uint32_t& s : sub) {
+            s = full ? result(s) : center(s);
+        }
+        const std::uint32_t a = result(join(sub[0], sub[1], sub[3], sub[4]));
+        const std::uint32_t b = result(join(sub[1], sub[2], sub[4], sub[5]));
+        const std::uint32_t c = result(join(sub[3], sub[4], sub[6], sub[7]));
+        const std::uint32_t d = result(join(sub[4], sub[5], sub[7], sub[8]));
+        r = join(a, b, c, d);
+    }
+    nodes[index].result = r;
+    return r;
+}
+
+void HashLife::clearResults() {
+    for (Node& n : nodes) {
+        n.result = 0;
+    }
+}
+
+void HashLife::expand() {
+    const Node n = nodes[root];
+    const std::uint32_t e = empty(n.level - 1);
+    root = join(join(e, e, e, n.nw), join(e, e, n.ne, e), join(e, n.sw, e, e), join(n.se, e, e, e));
+}
+
+bool HashLife::centered() const {
+    const Node& n = nodes[root];
+    const Node& nw = nodes[n.nw];
+    const Node& ne = nodes[n.ne];
+    const Node& sw = nodes[n.sw];
+    const Node& se = nodes[n.se];
+    const std::uint32_t outer[12] = {
+        nw.nw, nw.ne, nw.sw, ne.nw, ne.ne, ne.se, sw.nw, sw.sw, sw.se, se.ne, se.sw, se.se
+    };
+    for (std::uint32_t i : outer) {
+        if (nodes[i].population) return false;
+    }
+    return true;
+}
+
+bool HashLife::step() {
+    // The result covers the central half of the root: once the pattern is inside it, one more
+    // expansion leaves it in the central quarter with room to grow for the whole step
+    while (nodes[root].level < std::max(stepLog + 2, kMinRootLevel) || !centered()) {
+        if (nodes[root].level >= kMaxLevel) return false;
+        expand();
+    }
+    if (nodes[root].level >= kMaxLevel) return false;
+    expand();
+    if (memoryUsage() > memoryCap) {
+        collectGarbage(true);
+        if (memoryUsage() > memoryCap / 2) {
+            collectGarbage(false);
+        }
+    }
+    root = result(root);
+    generation += std::uint64_t(1) << stepLog;
+    return true;
+}
+
+bool HashLife::advance(std::uint64_t generations) {
+    for (int bit = 63; bit >= 0; bit--) {
+        if (!((generations >> bit) & 1)) continue;
+        if (stepLog != static_cast<unsigned int>(bit)) {
+            stepLog = bit;
+            clearResults();
+        }
+        if (!step()) return false;
+    }
+    return true;
+}
+
+void HashLife::collectGarbage(bool keepResults) {
+    // Mark everything reachable from the root and the empty nodes
+    std::vector<std::uint32_t> stack(emptyNodes.begin(), emptyNodes.end());
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const std::uint32_t i = stack.back();
+        stack.pop_back();
+        if (!i || nodes[i].marked) continue;
+        Node& n = nodes[i];
+        n.marked = true;
+        if (n.level > kLeafLevel) {
+            stack.insert(stack.end(), { n.nw, n.ne, n.sw, n.se });
+        }
+        if (keepResults) {
+            stack.push_back(n.result);
+        }
+    }
+
+    // Compact the marked nodes and renumber the links
+    std::vector<std::uint32_t> remap(nodes.size(), 0);
+    std::uint32_t count = 1;
+    for (std::uint32_t i = 1; i < nodes.size(); i++) {
+        if (nodes[i].marked) remap[i] = count++;
+    }
+    std::vector<Node> kept;
+    kept.reserve(count);
+    kept.push_back(Node());
+    for (std::uint32_t i = 1; i < nodes.size(); i++) {
+        Node n = nodes[i];
+        if (!n.marked) continue;
+        n.marked = false;
+        n.nw = remap[n.nw];
+        n.ne = remap[n.ne];
+        n.sw = remap[n.sw];
+        n.se = remap[n.se];
+        n.result = keepResults ? remap[n.result] : 0;
+        kept.push_back(n);
+    }
+    nodes.swap(kept);
+    for (std::uint32_t& e : emptyNodes) {
+        e = remap[e];
+    }
+    root = remap[root];
+
+    std::size_t size = std::size_t(1) << 16;
+    while (size < nodes.size()) size *= 2;
+    buckets = std::vector<std::uint32_t>();
+    rehash(size);
+}
+
+std::size_t HashLife::memoryUsage() const {
+    return nodes.capacity() * sizeof(Node) + buckets.capacity() * sizeof(std::uint32_t);
+}
+
+std::uint32_t HashLife::setRec(std::uint32_t index, std::uint64_t x, std::uint64_t y, bool alive) {
+    const Node n = nodes[index];
+    if (n.level == kLeafLevel) {
+        const std::uint64_t bit = std::uint64_t(1) << (x + 8 * y);
+        return leaf(alive ? (n.bits | bit) : (n.bits & ~bit));
+    }
+    const std::uint64_t half = std::uint64_t(1) << (n.level - 1);
+    const bool east = x >= half;
+    const bool south = y >= half;
+    const std::uint32_t child = south ? (east ? n.se : n.sw) : (east ? n.ne : n.nw);
+    const std::uint32_t updated = setRec(child, x & (half - 1), y & (half - 1), alive);
+    return join(!south && !east ? updated : n.nw, !south && east ? updated : n.ne,
+        south && !east ? updated : n.sw, south && east ? updated : n.se);
+}
+
+void HashLife::setCell(long long x, long long y, bool alive) {
+    auto inside = [&]() {
+        const long long half = 1ll << (nodes[root].level - 1);
+        return x >= -half && x < half && y >= -half && y < half;
+    };
+    while (!inside()) {
+        if (nodes[root].level >= kMaxLevel) return;
+        expand();
+    }
+    const std::uint64_t half = std::uint64_t(1) << (nodes[root].level - 1);
+    root = setRec(root, static_cast<std::uint64_t>(x) + half, static_cast<std::uint64_t>(y) + half, alive);
+}
+
+bool HashLife::isAlive(long long x, long long y) const {
+    const long long half = 1ll << (nodes[root].level - 1);
+    if (x < -half || x >= half || y < -half || y >= half) return false;
+    std::uint64_t lx = static_cast<std::uint64_t>(x + half);
+    std::uint64_t ly = static_cast<std::uint64_t>(y + half);
+    std::uint32_t i = root;
+    while (nodes[i].level > kLeafLevel) {
+        const Node& n = nodes[i];
+        const std::uint64_t h = std::uint64_t(1) << (n.level - 1);
+        i = ly >= h ? (lx >= h ? n.se : n.sw) : (lx >= h ? n.ne : n.nw);
+        lx &= h - 1;
+        ly &= h - 1;
+    }
+    return (nodes[i].bits >> (lx + 8 * ly)) & 1;
+}
+
+void HashLife::load(const GameOfLife& game) {
+    nodes.assign(1, Node());
+    buckets.assign(std::size_t(1) << 16, 0);
+    std::fill(emptyNodes.begin(), emptyNodes.end(), 0);
+    generation = 0;
+
+    // Leaves of the smallest square block that holds the grid, then their parents level by level
+    unsigned int level = 4;
+    while ((1u << level) < std::max(game.getWidth(), game.getHeight())) level++;
+    const unsigned int side = 1u << (level - kLeafLevel);
+    std::vector<std::uint32_t> blocks(static_cast<std::size_t>(side) * side);
+    for (unsigned int by = 0; by < side; by++) {
+        for (unsigned int bx = 0; bx < side; bx++) {
+            std::uint64_t bits = 0;
+            for (unsigned int y = 0; y < 8; y++) {
+                const unsigned int gy = by * 8 + y;
+                if (gy >= game.getHeight()) break;
+                for (unsigned int x = 0; x < 8; x++) {
+                    const unsigned int gx = bx * 8 + x;
+                    if (gx >= game.getWidth()) break;
+                    bits |= std::uint64_t(game.isAlive(gx, gy)) << (x + 8 * y);
+                }
+            }
+            blocks[static_cast<std::size_t>(by) * side + bx] = leaf(bits);
+        }
+    }
+    for (unsigned int size = side; size > 1; size /= 2) {
+        const unsigned int half = size / 2;
+        for (unsigned int j = 0; j < half; j++) {
+            for (unsigned int i = 0; i < half; i++) {
+                const std::size_t top = static_cast<std::size_t>(2 * j) * size + 2 * i;
+                blocks[static_cast<std::size_t>(j) * half + i] =
+                    join(blocks[top], blocks[top + 1], blocks[top + size], blocks[top + size + 1]);
+            }
+        }
+    }
+    // The block starts at the center of the root, so cell (0, 0) stays at the origin
+    const std::uint32_t e = empty(level);
+    root = join(e, e, e, blocks[0]);
+}
+
+void HashLife::storeRec(std::uint32_t index, long long x, long long y, GameOfLife& game, long long x0, long long y0) const {
+    const Node& n = nodes[index];
+    const long long size = 1ll << n.level;
+    if (n.population == 0 || x + size <= x0 || y + size <= y0 ||
+        x >= x0 + static_cast<long long>(game.getWidth()) || y >= y0 + static_cast<long long>(game.getHeight())) {
+        return;
+    }
+    if (n.level == kLeafLevel) {
+        for (std::uint64_t bits = n.bits; bits; bits &= bits - 1) {
+            const int bit = ctz64(bits);
+            const long long gx = x + (bit & 7) - x0;
+            const long long gy = y + (bit >> 3) - y0;
+            if (gx >= 0 && gy >= 0 && gx < static_cast<long long>(game.getWidth()) && gy < static_cast<long long>(game.getHeight())) {
+                game.setCell(static_cast<unsigned int>(gx), static_cast<unsigned int>(gy), true);
+            }
+        }
+        return;
+    }
+    const long long half = size / 2;
+    storeRec(n.nw, x, y, game, x0, y0);
+    storeRec(n.ne, x + half, y, game, x0, y0);
+    storeRec(n.sw, x, y + half, game, x0, y0);
+    storeRec(n.se, x + half, y + half, game, x0, y0);
+}
+
+void HashLife::store(GameOfLife& game, long long x0, long long y0) const {
+    game.clear();
+    const long long half = 1ll << (nodes[root].level - 1);
+    storeRec(root, -half, -half, game, x0, y0);
+}
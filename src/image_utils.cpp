@@ -2,6 +2,203 @@
 #include <chrono>
 #include <iomanip>
 #include <sstream> 
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <fstream>
+#include <cstdlib>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// stb_image_write is compiled here, next to writePNG16(), which uses its zlib encoder, so any
+// program that links the generators can also save images
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "../libs/stb/stb_image_write.h"
+
+namespace {
+
+// Kaiser-windowed sinc for 2x decimation: 8 taps centered between the two source pixels
+constexpr int kKaiserTaps = 8;
+constexpr double kKaiserBeta = 4.0;
+
+// Modified Bessel function of the first kind, order 0 (power series)
+double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+void kaiserWeights(float* weights) {
+    const double pi = 3.14159265358979323846;
+    const double half = kKaiserTaps / 2.0;
+    double total = 0.0;
+    double w[kKaiserTaps];
+    for (int k = 0; k < kKaiserTaps; ++k) {
+        const double d = k - (kKaiserTaps - 1) / 2.0; // -3.5 ... 3.5
+        const double t = d / 2.0;                     // Cutoff at half the source Nyquist
+        const double sinc = std::sin(pi * t) / (pi * t);
+        const double r = d / half;
+        w[k] = sinc * besselI0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(kKaiserBeta);
+        total += w[k];
+    }
+    for (int k = 0; k < kKaiserTaps; ++k) {
+        weights[k] = static_cast<float>(w[k] / total);
+    }
+}
+
+// Box level: each output pixel averages a 2x2 block, wrapping at odd edges
+void boxLevel(const unsigned char* src, unsigned int w, unsigned int h, unsigned char* dst, unsigned int nw, unsigned int nh) {
+    for (unsigned int y = 0; y < nh; ++y) {
+        const unsigned char* ra = src + (2 * y % h) * w * 4;
+        const unsigned char* rb = src + ((2 * y + 1) % h) * w * 4;
+        unsigned char* out = dst + y * nw * 4;
+        unsigned int x = 0;
+#if defined(__AVX2__)
+        if (2 * nw <= w) {
+            // Pair the same channel of neighbouring pixels so that maddubs adds them horizontally
+            const __m256i pairs = _mm256_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15,
+                                                   0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+            const __m256i ones = _mm256_set1_epi8(1);
+            const __m256i two = _mm256_set1_epi16(2);
+            auto sums = [&](const unsigned char* a, const unsigned char* b) {
+                const __m256i ha = _mm256_maddubs_epi16(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)), pairs), ones);
+                const __m256i hb = _mm256_maddubs_epi16(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)), pairs), ones);
+                return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(ha, hb), two), 2);
+            };
+            for (; x + 8 <= nw; x += 8) {
+                const __m256i s0 = sums(ra + x * 8, rb + x * 8);
+                const __m256i s1 = sums(ra + x * 8 + 32, rb + x * 8 + 32);
+                // packus interleaves the 128-bit lanes: restore the pixel order
+                const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(s0, s1), 0xD8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), packed);
+            }
+        }
+#endif
+        for (; x < nw; ++x) {
+            const unsigned int xa = (2 * x % w) * 4;
+            const unsigned int xb = ((2 * x + 1) % w) * 4;
+            for (int c = 0; c < 4; ++c) {
+                out[x * 4 + c] = static_cast<unsigned char>((ra[xa + c] + ra[xb + c] + rb[xa + c] + rb[xb + c] + 2) >> 2);
+            }
+        }
+    }
+}
+
+// Kaiser level, one output row at a time: vertical taps into a float row, then horizontal taps.
+// `src` is the byte image for the first level and the float result of the previous one after.
+template <typename T>
+void kaiserLevel(const T* src, unsigned int w, unsigned int h, float* dst, unsigned int nw, unsigned int nh,
+    const float* weights) {
+    const int reach = kKaiserTaps / 2 - 1;
+    std::vector<float> column(static_cast<size_t>(w) * 4);
+    std::vector<float> padded((w + kKaiserTaps) * 4);
+    for (unsigned int y = 0; y < nh; ++y) {
+        const T* in[kKaiserTaps];
+        for (int k = 0; k < kKaiserTaps; ++k) {
+            in[k] = src + static_cast<size_t>(h == nh ? y : (2 * y + h * kKaiserTaps - reach + k) % h) * w * 4;
+        }
+        unsigned int i = 0;
+        if (h == nh) {
+            for (; i < w * 4; ++i) column[i] = static_cast<float>(in[0][i]);
+        }
+#if defined(__AVX2__)
+        for (; i + 8 <= w * 4; i += 8) {
+            __m256 acc = _mm256_setzero_ps();
+            for (int k = 0; k < kKaiserTaps; ++k) {
+                __m256 v;
+                if constexpr (std::is_same<T, float>::value) {
+                    v = _mm256_loadu_ps(in[k] + i);
+                } else {
+                    v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in[k] + i))));
+                }
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(weights[k]), v));
+            }
+            _mm256_storeu_ps(&column[i], acc);
+        }
+#endif
+        for (; i < w * 4; ++i) {
+            float acc = 0.0f;
+            for (int k = 0; k < kKaiserTaps; ++k) {
+                acc += weights[k] * in[k][i];
+            }
+            column[i] = acc;
+        }
+
+        float* out = dst + static_cast<size_t>(y) * nw * 4;
+        if (w == nw) {
+            std::copy(column.begin(), column.end(), out);
+            continue;
+        }
+        // Row extended with `reach` pixels on the left and the rest on the right, wrapped
+        for (unsigned int p = 0; p < w + kKaiserTaps; ++p) {
+            const unsigned int sx = (p + w * kKaiserTaps - reach) % w;
+            std::copy(&column[sx * 4], &column[sx * 4] + 4, &padded[p * 4]);
+        }
+        for (unsigned int x = 0; x < nw; ++x) {
+#if defined(__AVX2__)
+            // One RGBA pixel per 128-bit register
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < kKaiserTaps; ++k) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(&padded[(2 * x + k) * 4])));
+            }
+            _mm_storeu_ps(out + x * 4, acc);
+#else
+            for (int c = 0; c < 4; ++c) {
+                float acc = 0.0f;
+                for (int k = 0; k < kKaiserTaps; ++k) {
+                    acc += weights[k] * padded[(2 * x + k) * 4 + c];
+                }
+                out[x * 4 + c] = acc;
+            }
+#endif
+        }
+    }
+}
+
+// CRC-32 of the PNG chunks (polynomial 0xedb88320)
+std::uint32_t crc32(const unsigned char* data, std::size_t size, std::uint32_t crc = 0xffffffffu) {
+    static const auto table = [] {
+        std::vector<std::uint32_t> t(256);
+        for (std::uint32_t n = 0; n < 256; n++) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    for (std::size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+void putBigEndian(std::vector<unsigned char>& out, std::uint32_t v) {
+    out.push_back(static_cast<unsigned char>(v >> 24));
+    out.push_back(static_cast<unsigned char>(v >> 16));
+    out.push_back(static_cast<unsigned char>(v >> 8));
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+void putChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, std::size_t size) {
+    putBigEndian(out, static_cast<std::uint32_t>(size));
+    const std::size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    putBigEndian(out, crc32(&out[start], size + 4) ^ 0xffffffffu);
+}
+
+// Paeth predictor of the PNG filters
+int paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return pa <= pb && pa <= pc ? a : (pb <= pc ? b : c);
+}
+
+}
 
 std::string generateUniqueFileName() {
     auto now = std::chrono::system_clock::now();
@@ -14,4 +211,110 @@ std::string generateUniqueFileName() {
         << ".png";
 
     return ss.str();
-}
\ No newline at end of file
+}
+
+void fillBlock(std::vector<unsigned char>& image, unsigned int width, unsigned int x, unsigned int y,
+    unsigned int w, unsigned int h, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    for (unsigned int by = y; by < y + h; ++by) {
+        unsigned char* row = &image[(by * width + x) * 4];
+        for (unsigned int bx = 0; bx < w; ++bx) {
+            row[bx * 4] = r;     // R
+            row[bx * 4 + 1] = g; // G
+            row[bx * 4 + 2] = b; // B
+            row[bx * 4 + 3] = a; // A
+        }
+    }
+}
+
+std::vector<std::vector<unsigned char>> buildMipChain(const std::vector<unsigned char>& image,
+    unsigned int width, unsigned int height, MipFilter filter) {
+    std::vector<std::vector<unsigned char>> chain;
+    chain.push_back(image);
+
+    float weights[kKaiserTaps];
+    std::vector<float> level, next;
+    if (filter == MipFilter::Kaiser) {
+        kaiserWeights(weights);
+    }
+
+    unsigned int w = width, h = height;
+    while (w > 1 || h > 1) {
+        const unsigned int nw = std::max(1u, w / 2);
+        const unsigned int nh = std::max(1u, h / 2);
+        std::vector<unsigned char> out(static_cast<size_t>(nw) * nh * 4);
+        if (filter == MipFilter::Box) {
+            boxLevel(chain.back().data(), w, h, out.data(), nw, nh);
+        } else {
+            // The Kaiser chain stays in float between levels, so rounding errors do not pile up
+            next.resize(out.size());
+            if (level.empty()) {
+                kaiserLevel(image.data(), w, h, next.data(), nw, nh, weights);
+            } else {
+                kaiserLevel(level.data(), w, h, next.data(), nw, nh, weights);
+            }
+            for (size_t i = 0; i < out.size(); ++i) {
+                out[i] = static_cast<unsigned char>(std::min(std::max(next[i] + 0.5f, 0.0f), 255.0f));
+            }
+            level.swap(next);
+        }
+        chain.push_back(std::move(out));
+        w = nw;
+        h = nh;
+    }
+    return chain;
+}
+
+std::vector<std::uint16_t> quantizeField(const std::vector<float>& field, float low, float high) {
+    std::vector<std::uint16_t> out(field.size());
+    const float scale = high > low ? 65535.0f / (high - low) : 0.0f;
+    for (size_t i = 0; i < field.size(); ++i) {
+        out[i] = static_cast<std::uint16_t>(std::min(std::max((field[i] - low) * scale + 0.5f, 0.0f), 65535.0f));
+    }
+    return out;
+}
+
+bool writePNG16(const std::string& fileName, const std::vector<std::uint16_t>& pixels, unsigned int width, unsigned int height) {
+    // Rows are stored big-endian behind a filter byte. Paeth suits smooth heightmaps: with
+    // 2 bytes per pixel each byte is predicted from the same byte of the neighbours.
+    const size_t rowBytes = static_cast<size_t>(width) * 2;
+    std::vector<unsigned char> raw((rowBytes + 1) * height), prev(rowBytes, 0), row(rowBytes);
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            const std::uint16_t v = pixels[static_cast<size_t>(y) * width + x];
+            row[x * 2] = static_cast<unsigned char>(v >> 8);
+            row[x * 2 + 1] = static_cast<unsigned char>(v);
+        }
+        unsigned char* out = &raw[y * (rowBytes + 1)];
+        out[0] = 4;
+        for (size_t i = 0; i < rowBytes; ++i) {
+            const int a = i >= 2 ? row[i - 2] : 0;
+            const int c = i >= 2 ? prev[i - 2] : 0;
+            out[i + 1] = static_cast<unsigned char>(row[i] - paeth(a, prev[i], c));
+        }
+        prev.swap(row);
+    }
+
+    int zlibSize = 0;
+    unsigned char* zlib = stbi_zlib_compress(raw.data(), static_cast<int>(raw.size()), &zlibSize, 8);
+    if (!zlib) return false;
+
+    std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    std::vector<unsigned char> header;
+    putBigEndian(header, width);
+    putBigEndian(header, height);
+    header.insert(header.end(), { 16, 0, 0, 0, 0 }); // 16-bit grayscale, no interlacing
+    putChunk(png, "IHDR", header.data(), header.size());
+    putChunk(png, "IDAT", zlib, static_cast<size_t>(zlibSize));
+    putChunk(png, "IEND", nullptr, 0);
+    std::free(zlib);
+
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
+
+bool writeRawField(const std::string& fileName, const std::vector<float>& field) {
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(field.data()), static_cast<std::streamsize>(field.size() * sizeof(float)));
+    return static_cast<bool>(file);
+}
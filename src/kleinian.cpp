@@ -0,0 +1,199 @@
+#include "../include/kleinian.hpp"
+#include "../include/image_utils.hpp"
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+namespace {
+
+using cplx = std::complex<double>;
+
+// Palabras de más de kMaxSegment píxeles no se dibujan (ramas que aún no convergen fuera de la vista)
+constexpr double kMaxSegment = 4096.0;
+
+}
+
+Kleinian::Kleinian(unsigned int w, unsigned int h, float zoom, float moveX, float moveY)
+    : width(w), height(h), zoom(zoom), moveX(moveX), moveY(moveY)
+{
+    epsilon = 1.0f;
+    maxDepth = 120;
+    sat_r = 1.0f;
+    sat_g = 0.7f;
+    sat_b = 0.5f;
+    ta = cplx(2.0, 0.0);
+    tb = cplx(2.0, 0.0);
+    buildGroup();
+}
+
+std::vector<unsigned char> Kleinian::generateImage(std::string& imageName)
+{
+    std::vector<unsigned char> image = generateKleinianImage();
+    imageName = "../assets/kleinian_" + generateUniqueFileName();
+    return image;
+}
+
+void Kleinian::setTraces(float ta_re, float ta_im, float tb_re, float tb_im)
+{
+    ta = cplx(ta_re, ta_im);
+    tb = cplx(tb_re, tb_im);
+    buildGroup();
+}
+
+void Kleinian::buildGroup()
+{
+    const cplx i(0.0, 1.0);
+
+    // Grandma's recipe: traza de ab y punto base z0
+    const cplx tab = (ta * tb - std::sqrt(ta * ta * tb * tb - 4.0 * (ta * ta + tb * tb))) / 2.0;
+    const cplx z0 = (tab - 2.0) * tb / (tb * tab - 2.0 * ta + 2.0 * i * tab);
+
+    Mobius a = { ta / 2.0, (ta * tab - 2.0 * tb + 4.0 * i) / ((2.0 * tab + 4.0) * z0),
+                 (ta * tab - 2.0 * tb - 4.0 * i) * z0 / (2.0 * tab - 4.0), ta / 2.0 };
+    Mobius b = { (tb - 2.0 * i) / 2.0, tb / 2.0, tb / 2.0, (tb + 2.0 * i) / 2.0 };
+
+    // Inversas (det = 1)
+    auto inverse = [](const Mobius& m) { return Mobius{ m.d, -m.b, -m.c, m.a }; };
+    gens[0] = a;
+    gens[1] = b;
+    gens[2] = inverse(a);
+    gens[3] = inverse(b);
+
+    auto multiply = [](const Mobius& m, const Mobius& n) {
+        return Mobius{ m.a * n.a + m.b * n.c, m.a * n.b + m.b * n.d,
+                       m.c * n.a + m.d * n.c, m.c * n.b + m.d * n.d };
+    };
+    // Punto fijo atractor de una transformación
+    auto fixedPoint = [](const Mobius& m) {
+        if (std::abs(m.c) < 1e-15) {
+            return m.b / (m.d - m.a);
+        }
+        const cplx root = std::sqrt((m.a - m.d) * (m.a - m.d) + 4.0 * m.b * m.c);
+        const cplx z1 = (m.a - m.d + root) / (2.0 * m.c);
+        const cplx z2 = (m.a - m.d - root) / (2.0 * m.c);
+        // La derivada en el punto fijo es 1 / (cz + d)^2: atrae si |cz + d| > 1
+        return std::abs(m.c * z1 + m.d) >= std::abs(m.c * z2 + m.d) ? z1 : z2;
+    };
+
+    // Para cada generador, los puntos fijos de las palabras especiales que empiezan por
+    // sus tres posibles sucesores: los extremos y el centro del arco de su rama
+    for (int g = 0; g < 4; ++g) {
+        const Mobius& g1 = gens[(g + 1) % 4];
+        const Mobius& g2 = gens[(g + 2) % 4];
+        const Mobius& g3 = gens[(g + 3) % 4];
+        fix[g][0] = fixedPoint(multiply(multiply(multiply(g1, g2), g3), gens[g]));
+        fix[g][1] = fixedPoint(gens[g]);
+        fix[g][2] = fixedPoint(multiply(multiply(multiply(g3, g2), g1), gens[g]));
+    }
+}
+
+void Kleinian::branch(const Mobius& word, int tag, int level, unsigned char letter, std::vector<unsigned char>& canvas)
+{
+    auto apply = [&word](const cplx& z) { return (word.a * z + word.b) / (word.c * z + word.d); };
+
+    // Imagen del arco de la rama: si cabe en epsilon píxeles se dibuja y se poda
+    const cplx p0 = apply(fix[tag][0]);
+    const cplx p1 = apply(fix[tag][1]);
+    const cplx p2 = apply(fix[tag][2]);
+    const double eps = epsilon / zoom;
+    if (level >= maxDepth || (std::abs(p1 - p0) < eps && std::abs(p2 - p1) < eps)) {
+        plotSegment(p0, p1, letter, canvas);
+        plotSegment(p1, p2, letter, canvas);
+        return;
+    }
+
+    // Hijos en el mismo sentido que el arco: tag + 1, tag, tag - 1 (nunca la inversa, tag + 2)
+    for (int k = 1; k >= -1; --k) {
+        const int next = (tag + k + 4) % 4;
+        const Mobius& g = gens[next];
+        const Mobius child = { word.a * g.a + word.b * g.c, word.a * g.b + word.b * g.d,
+                               word.c * g.a + word.d * g.c, word.c * g.b + word.d * g.d };
+        branch(child, next, level + 1, letter, canvas);
+    }
+}
+
+void Kleinian::plotSegment(cplx p, cplx q, unsigned char letter, std::vector<unsigned char>& canvas)
+{
+    // Del plano complejo a píxeles (inverso de la transformación de los demás generadores)
+    const double x0 = (p.real() - moveX) * zoom + width / 2.0;
+    const double y0 = (p.imag() - moveY) * zoom + height / 2.0;
+    const double x1 = (q.real() - moveX) * zoom + width / 2.0;
+    const double y1 = (q.imag() - moveY) * zoom + height / 2.0;
+    if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) || !std::isfinite(y1)) return;
+
+    // Segmentos completamente fuera de la imagen
+    if ((x0 < 0 && x1 < 0) || (y0 < 0 && y1 < 0) || (x0 >= width && x1 >= width) || (y0 >= height && y1 >= height)) return;
+
+    const double length = std::max(std::fabs(x1 - x0), std::fabs(y1 - y0));
+    if (length > kMaxSegment) return;
+    const int steps = static_cast<int>(std::ceil(length));
+    for (int s = 0; s <= steps; ++s) {
+        const double t = steps > 0 ? static_cast<double>(s) / steps : 0.0;
+        const double x = x0 + (x1 - x0) * t;
+        const double y = y0 + (y1 - y0) * t;
+        if (x < 0 || y < 0 || x >= width || y >= height) continue;
+        // Se queda la letra mayor, así el resultado no depende del orden de las tareas
+        unsigned char& pixel = canvas[static_cast<unsigned int>(y) * width + static_cast<unsigned int>(x)];
+        pixel = std::max(pixel, letter);
+    }
+}
+
+std::vector<unsigned char> Kleinian::generateKleinianImage()
+{
+    // Tareas: pares de primeras letras (4 x 3 palabras reducidas de longitud 2)
+    std::vector<std::pair<int, int>> tasks;
+    for (int first = 0; first < 4; ++first) {
+        for (int k = 1; k >= -1; --k) {
+            tasks.push_back({ first, (first + k + 4) % 4 });
+        }
+    }
+
+    const unsigned int threadCount = std::max(1u, std::min<unsigned int>(std::thread::hardware_concurrency(), tasks.size()));
+    std::vector<std::vector<unsigned char>> canvases(threadCount, std::vector<unsigned char>(width * height, 0));
+    std::atomic<size_t> nextTask(0);
+
+    auto worker = [&](unsigned int t) {
+        for (size_t task = nextTask++; task < tasks.size(); task = nextTask++) {
+            const int first = tasks[task].first;
+            const int second = tasks[task].second;
+            const Mobius& g = gens[first];
+            const Mobius& h = gens[second];
+            const Mobius word = { g.a * h.a + g.b * h.c, g.a * h.b + g.b * h.d,
+                                  g.c * h.a + g.d * h.c, g.c * h.b + g.d * h.d };
+            branch(word, second, 2, static_cast<unsigned char>(first + 1), canvases[t]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& th : threads) {
+        th.join();
+    }
+
+    // Un color por primera letra, permutando las saturaciones
+    const float palette[5][3] = {
+        { 0.0f, 0.0f, 0.0f },
+        { sat_r, sat_g, sat_b },
+        { sat_g, sat_b, sat_r },
+        { sat_b, sat_r, sat_g },
+        { 1.0f, 1.0f, 1.0f }
+    };
+
+    std::vector<unsigned char> image(width * height * 4); // 4 canales: RGBA
+    for (unsigned int p = 0; p < width * height; ++p) {
+        // Mismo criterio que plotSegment: la letra mayor de todos los lienzos
+        unsigned char letter = 0;
+        for (unsigned int t = 0; t < threadCount; ++t) {
+            letter = std::max(letter, canvases[t][p]);
+        }
+        image[p * 4] = static_cast<unsigned char>(255 * palette[letter][0]);     // R
+        image[p * 4 + 1] = static_cast<unsigned char>(255 * palette[letter][1]); // G
+        image[p * 4 + 2] = static_cast<unsigned char>(255 * palette[letter][2]); // B
+        image[p * 4 + 3] = 255;                                                  // A
+    }
+    return image;
+}
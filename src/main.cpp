@@ -1,9 +1,14 @@
 #include <SFML/Graphics.hpp>
 #include <filesystem>
+#include <memory>
+#include <future>
+#include <chrono>
 #include "../include/image_utils.hpp"
+#include "../include/foveated.hpp"
+#include "../include/chunks.hpp"
+#include "../include/hashlife.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "../libs/stb/stb_image.h"
-#define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "../libs/stb/stb_image_write.h"
 
 
@@ -16,6 +21,9 @@ int main() {
     Newton newton(width, height);
     PerlinNoise perlin(width, height);
     SimplexNoise simplex(width, height);
+    SpectralNoise spectral(width, height);
+    BlueNoise blue(width, height);
+    WorleyNoise worley(width, height);
     GameOfLife game(width, height);
 
     newton.setMaxIterations(50);
@@ -36,16 +44,62 @@ int main() {
 
     std::string fileName;
     std::vector<unsigned char> image_data;
-    image_data = mandelbrot.generateImage(fileName);
-   // image_data = perlin.generateImage(fileName);
-    //image_data = jl.generateImage(fileName);
-   // image_data = newton.generateImage(fileName);
-    //image_data = simplex.generateImage(fileName);
+
+    // Foveated mode: the area around the cursor renders at full quality and the periphery
+    // is refined over the following frames. Works with any fractal or noise generator.
+    bool foveated = true;
+    FoveatedRenderer<Mandelbrot> renderer(mandelbrot, width, height);
+    //FoveatedRenderer<PerlinNoise> renderer(perlin, width, height);
+
+    // Animated mode: every frame is a time slice of Simplex noise rendered into the same buffer
+    // and streamed to the texture. setLoop() makes the animation repeat without a seam.
+    bool animated = false;
+    std::vector<unsigned char> frame(width * height * 4);
+    sf::Clock clock;
+    simplex.setLoop(8.0);
+
+    // Streaming mode: a large Simplex landscape cut into chunks that background threads
+    // render around the view. Arrow keys scroll it without waiting for the new chunks. The
+    // streamer (and its threads) only exists in this mode.
+    bool streaming = false;
+    std::unique_ptr<ChunkStreamer<SimplexNoise>> world;
+    if (streaming) {
+        world = std::make_unique<ChunkStreamer<SimplexNoise>>(simplex);
+    }
+    long long worldX = 0;
+    long long worldY = 0;
+
+    // Life mode: the Game of Life advances one generation per frame, and only the tiles that
+    // changed are uploaded to the texture. Space jumps 4096 generations ahead with HashLife on
+    // a worker thread while the grid pauses. HashLife's plane does not wrap around like the
+    // grid, so cells near the edges evolve differently during a jump; the title warns about it.
+    bool life = false;
+    HashLife hashlife;
+    std::future<bool> jump;
+
+    // View controls of the Mandelbrot set: arrow keys to pan, mouse wheel to zoom. The other
+    // modes own the texture, so they ignore them (streaming uses the arrow keys to scroll).
+    float zoom = 300.0f;
+    float moveX = -0.5f;
+    float moveY = 0.0f;
+
+    if (!foveated && !animated && !streaming && !life) {
+        image_data = mandelbrot.generateImage(fileName);
+       // image_data = perlin.generateImage(fileName);
+        //image_data = jl.generateImage(fileName);
+       // image_data = newton.generateImage(fileName);
+        //image_data = simplex.generateImage(fileName);
+        //image_data = spectral.generateImage(fileName);
+        //image_data = blue.generateImage(fileName);
+        //image_data = worley.generateImage(fileName);
+    }
     
     // SFML Texture
     sf::Texture texture;
     texture.create(width, height);
-    texture.update(image_data.data());
+    if (!foveated && !animated && !streaming && !life) {
+        texture.update(image_data.data());
+    }
     // sprite to show texture
     sf::Sprite sprite(texture);
 
@@ -54,19 +108,101 @@ int main() {
     window.setFramerateLimit(60);
     // show window
     while (window.isOpen()) {
+        bool viewChanged = false;
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed)
                 window.close();
+            if (event.type == sf::Event::KeyPressed && life && event.key.code == sf::Keyboard::Space && !jump.valid()) {
+                hashlife.load(game);
+                jump = std::async(std::launch::async, [&hashlife] { return hashlife.advance(4096); });
+                window.setTitle("Algorithmic Abstract Art - HashLife jump (unbounded plane: edges do not wrap)");
+            }
+            if (event.type == sf::Event::KeyPressed && streaming) {
+                const long long worldStep = width / 8;
+                if (event.key.code == sf::Keyboard::Left) worldX -= worldStep;
+                if (event.key.code == sf::Keyboard::Right) worldX += worldStep;
+                if (event.key.code == sf::Keyboard::Up) worldY -= worldStep;
+                if (event.key.code == sf::Keyboard::Down) worldY += worldStep;
+                // Past this the float sampling of the noise loses pixel accuracy
+                const long long limit = ChunkStreamer<SimplexNoise>::kMaxCoordinate;
+                worldX = std::min(std::max(worldX, -limit), limit - static_cast<long long>(width));
+                worldY = std::min(std::max(worldY, -limit), limit - static_cast<long long>(height));
+            } else if (event.type == sf::Event::KeyPressed && !life && !animated) {
+                float panStep = width * 0.1f / zoom;
+                if (event.key.code == sf::Keyboard::Left) { moveX -= panStep; viewChanged = true; }
+                if (event.key.code == sf::Keyboard::Right) { moveX += panStep; viewChanged = true; }
+                if (event.key.code == sf::Keyboard::Up) { moveY -= panStep; viewChanged = true; }
+                if (event.key.code == sf::Keyboard::Down) { moveY += panStep; viewChanged = true; }
+            }
+            if (event.type == sf::Event::MouseWheelScrolled && !streaming && !life && !animated) {
+                zoom *= event.mouseWheelScroll.delta > 0 ? 1.25f : 0.8f;
+                viewChanged = true;
+            }
+        }
+
+        if (viewChanged) {
+            mandelbrot.setZoom(zoom);
+            mandelbrot.setMoveX(moveX);
+            mandelbrot.setMoveY(moveY);
+            if (foveated) {
+                renderer.restart();
+            } else {
+                image_data = mandelbrot.generateImage(fileName);
+                texture.update(image_data.data());
+            }
+        }
+
+        if (animated) {
+            simplex.renderFrame(frame, clock.getElapsedTime().asSeconds() * 0.5);
+            texture.update(frame.data());
+        } else if (streaming) {
+            world->setView(worldX, worldY, width, height);
+            world->compose(frame, worldX, worldY, width, height);
+            texture.update(frame.data());
+        } else if (life) {
+            if (jump.valid() && jump.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                jump.get();
+                hashlife.store(game);
+                window.setTitle("Algorithmic Abstract Art");
+            }
+            for (const LifeRegion& r : game.updateRegions()) {
+                texture.update(game.regionPixels().data() + r.offset, r.width, r.height, r.x, r.y);
+            }
+            if (!jump.valid()) {
+                game.nextGeneration();
+            }
+        } else if (foveated) {
+            // The fovea follows the cursor, or the view center when the cursor is outside
+            sf::Vector2i mouse = sf::Mouse::getPosition(window);
+            if (mouse.x >= 0 && mouse.y >= 0 && mouse.x < static_cast<int>(width) && mouse.y < static_cast<int>(height)) {
+                renderer.setFovea(mouse.x, mouse.y, std::min(width, height) / 6);
+            } else {
+                renderer.setFovea(width / 2, height / 2, std::min(width, height) / 6);
+            }
+            if (renderer.update(12.0f)) {
+                texture.update(renderer.pixels().data());
+            }
         }
-        //image_data = game.generateImage();
-        //texture.update(image_data.data());
-        //game.nextGeneration();
 
         window.clear();
         window.draw(sprite);
         window.display();
     }
+    if (animated) {
+        image_data = frame;
+        fileName = "../assets/simplex_noise_" + generateUniqueFileName();
+    } else if (streaming) {
+        image_data = frame;
+        fileName = "../assets/simplex_noise_" + generateUniqueFileName();
+    } else if (life) {
+        image_data = game.generateImage();
+        fileName = "../assets/game_of_life_" + generateUniqueFileName();
+    } else if (foveated) {
+        renderer.finish();
+        image_data = renderer.pixels();
+        fileName = "../assets/mandelbrot_" + generateUniqueFileName();
+    }
     if (!std::filesystem::exists("../assets")) {
         std::filesystem::create_directory("../assets");
     }
@@ -1,32 +1,951 @@
 #include <vector>
 #include <cmath>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <cstdint>
+#include <array>
 #include "../include/perlin.hpp"
 #include "../include/image_utils.hpp"
+#include "../include/parallel.hpp"
+#include "../include/lattice.hpp"
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
-PerlinNoise::PerlinNoise(unsigned int w, unsigned int h) {
-    width = w;
-    height = h;
-    scale = 20;
-    mode = 2;
-    p = std::vector<int>(512);
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());  
-    std::uniform_int_distribution<int> dis(0, 255);  
+namespace {
+
+// Simplex skew/unskew factors
+const float kF2 = 0.36602540378443864676f; // 0.5 * (sqrt(3) - 1)
+const float kG2 = 0.21132486540518711775f; // (3 - sqrt(3)) / 6
+
+// Permutation of 0..255 for a seed, repeated twice so that `p[p[x] + y + 1]` needs no wrap.
+// Fisher-Yates driven by splitmix64: fixed across platforms and standard libraries, unlike
+// the distributions of <random>, and constexpr so the default table is built by the compiler.
+constexpr std::array<int, 512> makePermutation(std::uint32_t seed) {
+    std::array<int, 512> p{};
+    for (int i = 0; i < 256; i++) p[i] = i;
+    std::uint64_t state = seed;
+    for (int i = 255; i > 0; i--) {
+        state += 0x9e3779b97f4a7c15ull;
+        std::uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z ^= z >> 31;
+        const int j = static_cast<int>(z % static_cast<std::uint64_t>(i + 1));
+        const int t = p[i];
+        p[i] = p[j];
+        p[j] = t;
+    }
+    for (int i = 0; i < 256; i++) p[i + 256] = p[i];
+    return p;
+}
+
+constexpr std::array<int, 512> kDefaultPermutation = makePermutation(0);
+
+// Coordinates are clamped to +-2^24 cells before they are split into cell and fraction: beyond
+// that a float no longer has a fractional part (the noise is flat there anyway), and the cell
+// still converts exactly to int32 in the scalar and SIMD paths.
+constexpr float kMaxLatticeCell = 16777216.0f;
+
+#if defined(__AVX512F__)
+
+inline __m512 fade16(__m512 t) {
+    __m512 r = _mm512_add_ps(_mm512_mul_ps(t, _mm512_set1_ps(6.0f)), _mm512_set1_ps(-15.0f));
+    r = _mm512_add_ps(_mm512_mul_ps(t, r), _mm512_set1_ps(10.0f));
+    return _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(t, t), t), r);
+}
+
+inline __m512 lerp16(__m512 a, __m512 b, __m512 t) {
+    return _mm512_add_ps(a, _mm512_mul_ps(t, _mm512_sub_ps(b, a)));
+}
+
+// grad(): (h & 15) < 8 picks x or y, (h & 1) flips the sign
+inline __m512 grad16(__m512i hash, __m512 x, __m512 y) {
+    const __m512i h = _mm512_and_si512(hash, _mm512_set1_epi32(15));
+    const __m512 u = _mm512_mask_blend_ps(_mm512_cmpgt_epi32_mask(h, _mm512_set1_epi32(7)), x, y);
+    const __m512i sign = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(1)), 31);
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(u), sign));
+}
+
+// Lattice cell modulo the period, and the next cell (wrapping to 0)
+inline void wrap16(__m512 f, __m512 period, __m512i& c0, __m512i& c1) {
+    const __m512 q = _mm512_roundscale_ps(_mm512_div_ps(f, period), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    c0 = _mm512_cvtps_epi32(_mm512_sub_ps(f, _mm512_mul_ps(q, period)));
+    c1 = _mm512_add_epi32(c0, _mm512_set1_epi32(1));
+    c1 = _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(c1, _mm512_cvtps_epi32(period)), c1, _mm512_setzero_si512());
+}
+
+// Perlin noise, 16 points per iteration. Returns how many points were processed.
+// Hashed: corners are hashed with the seed instead of looked up in `p`; period 0 = unbounded.
+template <bool Hashed>
+std::size_t perlinBatchSimd(const int* p, std::uint32_t seed, const float* xs, const float* ys, float* out,
+    std::size_t count, int periodX, int periodY) {
+    const __m512i hashSeed = _mm512_set1_epi32(static_cast<int>(seed));
+    const __m512 px = _mm512_set1_ps(static_cast<float>(periodX));
+    const __m512 py = _mm512_set1_ps(static_cast<float>(periodY));
+    const __m512 lo = _mm512_set1_ps(-kMaxLatticeCell);
+    const __m512 hi = _mm512_set1_ps(kMaxLatticeCell);
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512 x = _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(xs + i), lo), hi);
+        const __m512 y = _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(ys + i), lo), hi);
+        const __m512 fx = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        const __m512 fy = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        __m512i X, X1, Y, Y1;
+        if (periodX > 0) {
+            wrap16(fx, px, X, X1);
+            wrap16(fy, py, Y, Y1);
+        } else {
+            X = _mm512_cvtps_epi32(fx);
+            Y = _mm512_cvtps_epi32(fy);
+            X1 = _mm512_add_epi32(X, _mm512_set1_epi32(1));
+            Y1 = _mm512_add_epi32(Y, _mm512_set1_epi32(1));
+        }
+        const __m512 xf = _mm512_sub_ps(x, fx);
+        const __m512 yf = _mm512_sub_ps(y, fy);
+        const __m512 u = fade16(xf);
+        const __m512 v = fade16(yf);
+
+        __m512i haa, hba, hab, hbb;
+        if constexpr (Hashed) {
+            haa = latticeHash16(X, Y, hashSeed);
+            hba = latticeHash16(X1, Y, hashSeed);
+            hab = latticeHash16(X, Y1, hashSeed);
+            hbb = latticeHash16(X1, Y1, hashSeed);
+        } else {
+            const __m512i pX = _mm512_i32gather_epi32(X, p, 4);
+            const __m512i pX1 = _mm512_i32gather_epi32(X1, p, 4);
+            haa = _mm512_i32gather_epi32(_mm512_add_epi32(pX, Y), p, 4);
+            hba = _mm512_i32gather_epi32(_mm512_add_epi32(pX1, Y), p, 4);
+            hab = _mm512_i32gather_epi32(_mm512_add_epi32(pX, Y1), p, 4);
+            hbb = _mm512_i32gather_epi32(_mm512_add_epi32(pX1, Y1), p, 4);
+        }
+
+        const __m512 xm1 = _mm512_sub_ps(xf, _mm512_set1_ps(1.0f));
+        const __m512 ym1 = _mm512_sub_ps(yf, _mm512_set1_ps(1.0f));
+        const __m512 x1 = lerp16(grad16(haa, xf, yf), grad16(hba, xm1, yf), u);
+        const __m512 x2 = lerp16(grad16(hab, xf, ym1), grad16(hbb, xm1, ym1), u);
+        const __m512 n = _mm512_mul_ps(_mm512_add_ps(lerp16(x1, x2, v), _mm512_set1_ps(1.0f)), _mm512_set1_ps(0.5f));
+        _mm512_storeu_ps(out + i, n);
+    }
+    return i;
+}
+
+// Contribution of one simplex corner: max(t, 0)^4 * dot(grad, (x, y))
+inline __m512 corner16(__m512 x, __m512 y, __m512i gi) {
+    // Gradient table {1,1},{-1,1},{1,-1},{-1,-1},{1,0},{-1,0},{0,1},{0,-1}, repeated twice
+    const __m512 gxTable = _mm512_setr_ps(1, -1, 1, -1, 1, -1, 0, 0, 1, -1, 1, -1, 1, -1, 0, 0);
+    const __m512 gyTable = _mm512_setr_ps(1, 1, -1, -1, 0, 0, 1, -1, 1, 1, -1, -1, 0, 0, 1, -1);
+    const __m512 gx = _mm512_permutexvar_ps(gi, gxTable);
+    const __m512 gy = _mm512_permutexvar_ps(gi, gyTable);
+    __m512 t = _mm512_sub_ps(_mm512_set1_ps(0.5f), _mm512_add_ps(_mm512_mul_ps(x, x), _mm512_mul_ps(y, y)));
+    t = _mm512_max_ps(t, _mm512_setzero_ps());
+    t = _mm512_mul_ps(t, t);
+    t = _mm512_mul_ps(t, t);
+    return _mm512_mul_ps(t, _mm512_add_ps(_mm512_mul_ps(gx, x), _mm512_mul_ps(gy, y)));
+}
+
+// Simplex noise, 16 points per iteration. Returns how many points were processed.
+std::size_t simplexBatchSimd(const int* perm, const float* xs, const float* ys, float* out, std::size_t count) {
+    const __m512i mask = _mm512_set1_epi32(255);
+    const __m512i seven = _mm512_set1_epi32(7);
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512 G2 = _mm512_set1_ps(kG2);
+    std::size_t n = 0;
+    for (; n + 16 <= count; n += 16) {
+        const __m512 x = _mm512_loadu_ps(xs + n);
+        const __m512 y = _mm512_loadu_ps(ys + n);
+        const __m512 s = _mm512_mul_ps(_mm512_add_ps(x, y), _mm512_set1_ps(kF2));
+        const __m512 fi = _mm512_roundscale_ps(_mm512_add_ps(x, s), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        const __m512 fj = _mm512_roundscale_ps(_mm512_add_ps(y, s), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        const __m512 t = _mm512_mul_ps(_mm512_add_ps(fi, fj), G2);
+        const __m512 x0 = _mm512_sub_ps(x, _mm512_sub_ps(fi, t));
+        const __m512 y0 = _mm512_sub_ps(y, _mm512_sub_ps(fj, t));
+
+        // Lower or upper triangle
+        const __mmask16 upper = _mm512_cmp_ps_mask(x0, y0, _CMP_GT_OQ);
+        const __m512 i1 = _mm512_mask_blend_ps(upper, _mm512_setzero_ps(), _mm512_set1_ps(1.0f));
+        const __m512 j1 = _mm512_sub_ps(_mm512_set1_ps(1.0f), i1);
+        const __m512 x1 = _mm512_add_ps(_mm512_sub_ps(x0, i1), G2);
+        const __m512 y1 = _mm512_add_ps(_mm512_sub_ps(y0, j1), G2);
+        const __m512 x2 = _mm512_add_ps(_mm512_sub_ps(x0, _mm512_set1_ps(1.0f)), _mm512_set1_ps(2.0f * kG2));
+        const __m512 y2 = _mm512_add_ps(_mm512_sub_ps(y0, _mm512_set1_ps(1.0f)), _mm512_set1_ps(2.0f * kG2));
+
+        const __m512i ii = _mm512_and_si512(_mm512_cvtps_epi32(fi), mask);
+        const __m512i jj = _mm512_and_si512(_mm512_cvtps_epi32(fj), mask);
+        const __m512i ii1 = _mm512_add_epi32(ii, _mm512_cvtps_epi32(i1));
+        const __m512i jj1 = _mm512_add_epi32(jj, _mm512_cvtps_epi32(j1));
+        const __m512i gi0 = _mm512_and_si512(_mm512_i32gather_epi32(
+            _mm512_add_epi32(ii, _mm512_i32gather_epi32(jj, perm, 4)), perm, 4), seven);
+        const __m512i gi1 = _mm512_and_si512(_mm512_i32gather_epi32(
+            _mm512_add_epi32(ii1, _mm512_i32gather_epi32(jj1, perm, 4)), perm, 4), seven);
+        const __m512i gi2 = _mm512_and_si512(_mm512_i32gather_epi32(
+            _mm512_add_epi32(_mm512_add_epi32(ii, one), _mm512_i32gather_epi32(_mm512_add_epi32(jj, one), perm, 4)), perm, 4), seven);
+
+        const __m512 sum = _mm512_add_ps(_mm512_add_ps(corner16(x0, y0, gi0), corner16(x1, y1, gi1)), corner16(x2, y2, gi2));
+        _mm512_storeu_ps(out + n, _mm512_mul_ps(sum, _mm512_set1_ps(70.0f)));
+    }
+    return n;
+}
+
+#elif defined(__AVX2__)
+
+inline __m256 fade8(__m256 t) {
+    __m256 r = _mm256_add_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(-15.0f));
+    r = _mm256_add_ps(_mm256_mul_ps(t, r), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), r);
+}
+
+inline __m256 lerp8(__m256 a, __m256 b, __m256 t) {
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+// grad(): (h & 15) < 8 picks x or y, (h & 1) flips the sign
+inline __m256 grad8(__m256i hash, __m256 x, __m256 y) {
+    const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+    const __m256 useY = _mm256_castsi256_ps(_mm256_cmpgt_epi32(h, _mm256_set1_epi32(7)));
+    const __m256 u = _mm256_blendv_ps(x, y, useY);
+    const __m256i sign = _mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31);
+    return _mm256_xor_ps(u, _mm256_castsi256_ps(sign));
+}
+
+// Lattice cell modulo the period, and the next cell (wrapping to 0)
+inline void wrap8(__m256 f, __m256 period, __m256i& c0, __m256i& c1) {
+    const __m256 q = _mm256_floor_ps(_mm256_div_ps(f, period));
+    c0 = _mm256_cvtps_epi32(_mm256_sub_ps(f, _mm256_mul_ps(q, period)));
+    c1 = _mm256_add_epi32(c0, _mm256_set1_epi32(1));
+    c1 = _mm256_andnot_si256(_mm256_cmpeq_epi32(c1, _mm256_cvtps_epi32(period)), c1);
+}
+
+// Perlin noise, 8 points per iteration. Returns how many points were processed.
+// Hashed: corners are hashed with the seed instead of looked up in `p`; period 0 = unbounded.
+template <bool Hashed>
+std::size_t perlinBatchSimd(const int* p, std::uint32_t seed, const float* xs, const float* ys, float* out,
+    std::size_t count, int periodX, int periodY) {
+    const __m256i hashSeed = _mm256_set1_epi32(static_cast<int>(seed));
+    const __m256 px = _mm256_set1_ps(static_cast<float>(periodX));
+    const __m256 py = _mm256_set1_ps(static_cast<float>(periodY));
+    const __m256 lo = _mm256_set1_ps(-kMaxLatticeCell);
+    const __m256 hi = _mm256_set1_ps(kMaxLatticeCell);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(xs + i), lo), hi);
+        const __m256 y = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(ys + i), lo), hi);
+        const __m256 fx = _mm256_floor_ps(x);
+        const __m256 fy = _mm256_floor_ps(y);
+        __m256i X, X1, Y, Y1;
+        if (periodX > 0) {
+            wrap8(fx, px, X, X1);
+            wrap8(fy, py, Y, Y1);
+        } else {
+            X = _mm256_cvtps_epi32(fx);
+            Y = _mm256_cvtps_epi32(fy);
+            X1 = _mm256_add_epi32(X, _mm256_set1_epi32(1));
+            Y1 = _mm256_add_epi32(Y, _mm256_set1_epi32(1));
+        }
+        const __m256 xf = _mm256_sub_ps(x, fx);
+        const __m256 yf = _mm256_sub_ps(y, fy);
+        const __m256 u = fade8(xf);
+        const __m256 v = fade8(yf);
+
+        __m256i haa, hba, hab, hbb;
+        if constexpr (Hashed) {
+            haa = latticeHash8(X, Y, hashSeed);
+            hba = latticeHash8(X1, Y, hashSeed);
+            hab = latticeHash8(X, Y1, hashSeed);
+            hbb = latticeHash8(X1, Y1, hashSeed);
+        } else {
+            const __m256i pX = _mm256_i32gather_epi32(p, X, 4);
+            const __m256i pX1 = _mm256_i32gather_epi32(p, X1, 4);
+            haa = _mm256_i32gather_epi32(p, _mm256_add_epi32(pX, Y), 4);
+            hba = _mm256_i32gather_epi32(p, _mm256_add_epi32(pX1, Y), 4);
+            hab = _mm256_i32gather_epi32(p, _mm256_add_epi32(pX, Y1), 4);
+            hbb = _mm256_i32gather_epi32(p, _mm256_add_epi32(pX1, Y1), 4);
+        }
+
+        const __m256 xm1 = _mm256_sub_ps(xf, _mm256_set1_ps(1.0f));
+        const __m256 ym1 = _mm256_sub_ps(yf, _mm256_set1_ps(1.0f));
+        const __m256 x1 = lerp8(grad8(haa, xf, yf), grad8(hba, xm1, yf), u);
+        const __m256 x2 = lerp8(grad8(hab, xf, ym1), grad8(hbb, xm1, ym1), u);
+        const __m256 n = _mm256_mul_ps(_mm256_add_ps(lerp8(x1, x2, v), _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.5f));
+        _mm256_storeu_ps(out + i, n);
+    }
+    return i;
+}
+
+// Contribution of one simplex corner: max(t, 0)^4 * dot(grad, (x, y))
+inline __m256 corner8(__m256 x, __m256 y, __m256i gi) {
+    // Gradient table {1,1},{-1,1},{1,-1},{-1,-1},{1,0},{-1,0},{0,1},{0,-1}
+    const __m256 gxTable = _mm256_setr_ps(1, -1, 1, -1, 1, -1, 0, 0);
+    const __m256 gyTable = _mm256_setr_ps(1, 1, -1, -1, 0, 0, 1, -1);
+    const __m256 gx = _mm256_permutevar8x32_ps(gxTable, gi);
+    const __m256 gy = _mm256_permutevar8x32_ps(gyTable, gi);
+    __m256 t = _mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+    t = _mm256_max_ps(t, _mm256_setzero_ps());
+    t = _mm256_mul_ps(t, t);
+    t = _mm256_mul_ps(t, t);
+    return _mm256_mul_ps(t, _mm256_add_ps(_mm256_mul_ps(gx, x), _mm256_mul_ps(gy, y)));
+}
+
+// Simplex noise, 8 points per iteration. Returns how many points were processed.
+std::size_t simplexBatchSimd(const int* perm, const float* xs, const float* ys, float* out, std::size_t count) {
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i seven = _mm256_set1_epi32(7);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 G2 = _mm256_set1_ps(kG2);
+    std::size_t n = 0;
+    for (; n + 8 <= count; n += 8) {
+        const __m256 x = _mm256_loadu_ps(xs + n);
+        const __m256 y = _mm256_loadu_ps(ys + n);
+        const __m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), _mm256_set1_ps(kF2));
+        const __m256 fi = _mm256_floor_ps(_mm256_add_ps(x, s));
+        const __m256 fj = _mm256_floor_ps(_mm256_add_ps(y, s));
+        const __m256 t = _mm256_mul_ps(_mm256_add_ps(fi, fj), G2);
+        const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(fi, t));
+        const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(fj, t));
+
+        // Lower or upper triangle
+        const __m256 upper = _mm256_cmp_ps(x0, y0, _CMP_GT_OQ);
+        const __m256 i1 = _mm256_and_ps(upper, _mm256_set1_ps(1.0f));
+        const __m256 j1 = _mm256_sub_ps(_mm256_set1_ps(1.0f), i1);
+        const __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, i1), G2);
+        const __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, j1), G2);
+        const __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2.0f * kG2));
+        const __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2.0f * kG2));
+
+        const __m256i ii = _mm256_and_si256(_mm256_cvtps_epi32(fi), mask);
+        const __m256i jj = _mm256_and_si256(_mm256_cvtps_epi32(fj), mask);
+        const __m256i ii1 = _mm256_add_epi32(ii, _mm256_cvtps_epi32(i1));
+        const __m256i jj1 = _mm256_add_epi32(jj, _mm256_cvtps_epi32(j1));
+        const __m256i gi0 = _mm256_and_si256(_mm256_i32gather_epi32(perm,
+            _mm256_add_epi32(ii, _mm256_i32gather_epi32(perm, jj, 4)), 4), seven);
+        const __m256i gi1 = _mm256_and_si256(_mm256_i32gather_epi32(perm,
+            _mm256_add_epi32(ii1, _mm256_i32gather_epi32(perm, jj1, 4)), 4), seven);
+        const __m256i gi2 = _mm256_and_si256(_mm256_i32gather_epi32(perm,
+            _mm256_add_epi32(_mm256_add_epi32(ii, one), _mm256_i32gather_epi32(perm, _mm256_add_epi32(jj, one), 4)), 4), seven);
+
+        const __m256 sum = _mm256_add_ps(_mm256_add_ps(corner8(x0, y0, gi0), corner8(x1, y1, gi1)), corner8(x2, y2, gi2));
+        _mm256_storeu_ps(out + n, _mm256_mul_ps(sum, _mm256_set1_ps(70.0f)));
+    }
+    return n;
+}
+
+#else
+
+// Scalar builds: the batch functions fall back to the per-point noise()
+template <bool Hashed>
+std::size_t perlinBatchSimd(const int*, std::uint32_t, const float*, const float*, float*, std::size_t, int, int) { return 0; }
+std::size_t simplexBatchSimd(const int*, const float*, const float*, float*, std::size_t) { return 0; }
+
+#endif
+
+// Simplex noise in 3D and 4D, used for the time axis
+const float kF3 = 1.0f / 3.0f;
+const float kG3 = 1.0f / 6.0f;
+const float kF4 = 0.30901699437494742410f; // (sqrt(5) - 1) / 4
+const float kG4 = 0.13819660112501051518f; // (5 - sqrt(5)) / 20
+
+// Gradients to the edge midpoints of a cube, padded to 16 so that the hash is just masked
+const float kGrad3[3][16] = {
+    { 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0, 1, -1, 0, 0 },
+    { 1, 1, -1, -1, 0, 0, 0, 0, 1, -1, 1, -1, 1, 1, -1, -1 },
+    { 0, 0, 0, 0, 1, 1, -1, -1, 1, 1, -1, -1, 0, 0, 1, -1 }
+};
+
+// Gradients to the edge midpoints of a tesseract: one zero coordinate, the others +-1
+const float kGrad4[4][32] = {
+    { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, -1, -1, -1, -1, 1, 1, 1, 1, -1, -1, -1, -1, 1, 1, 1, 1, -1, -1, -1, -1 },
+    { 1, 1, 1, 1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, -1, -1, 1, 1, -1, -1, 1, 1, -1, -1, 1, 1, -1, -1 },
+    { 1, 1, -1, -1, 1, 1, -1, -1, 1, 1, -1, -1, 1, 1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1 },
+    { 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0, 0, 0, 0, 0 }
+};
+
+inline float falloff(float t) {
+    t = std::max(t, 0.0f);
+    t *= t;
+    return t * t;
+}
+
+float simplex3(const int* perm, float x, float y, float z) {
+    const float s = (x + y + z) * kF3;
+    const float fi = std::floor(x + s), fj = std::floor(y + s), fk = std::floor(z + s);
+    const float t = (fi + fj + fk) * kG3;
+    const float x0 = x - (fi - t), y0 = y - (fj - t), z0 = z - (fk - t);
+
+    // Rank of each coordinate: the simplex walks the axes from the largest to the smallest
+    const int rx = (x0 > y0) + (x0 > z0);
+    const int ry = (y0 >= x0) + (y0 > z0);
+    const int rz = (z0 >= x0) + (z0 >= y0);
+    const int i1 = rx >= 2, j1 = ry >= 2, k1 = rz >= 2;
+    const int i2 = rx >= 1, j2 = ry >= 1, k2 = rz >= 1;
+
+    const int ii = static_cast<int>(fi) & 255, jj = static_cast<int>(fj) & 255, kk = static_cast<int>(fk) & 255;
+    const int g[4] = {
+        perm[ii + perm[jj + perm[kk]]] & 15,
+        perm[ii + i1 + perm[jj + j1 + perm[kk + k1]]] & 15,
+        perm[ii + i2 + perm[jj + j2 + perm[kk + k2]]] & 15,
+        perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]] & 15
+    };
+    const float cx[4] = { x0, x0 - i1 + kG3, x0 - i2 + 2 * kG3, x0 - 1 + 3 * kG3 };
+    const float cy[4] = { y0, y0 - j1 + kG3, y0 - j2 + 2 * kG3, y0 - 1 + 3 * kG3 };
+    const float cz[4] = { z0, z0 - k1 + kG3, z0 - k2 + 2 * kG3, z0 - 1 + 3 * kG3 };
+
+    float sum = 0.0f;
+    for (int c = 0; c < 4; c++) {
+        sum += falloff(0.6f - cx[c] * cx[c] - cy[c] * cy[c] - cz[c] * cz[c]) *
+            (kGrad3[0][g[c]] * cx[c] + kGrad3[1][g[c]] * cy[c] + kGrad3[2][g[c]] * cz[c]);
+    }
+    return 32.0f * sum;
+}
+
+float simplex4(const int* perm, float x, float y, float z, float w) {
+    const float s = (x + y + z + w) * kF4;
+    const float fi = std::floor(x + s), fj = std::floor(y + s), fk = std::floor(z + s), fl = std::floor(w + s);
+    const float t = (fi + fj + fk + fl) * kG4;
+    const float x0 = x - (fi - t), y0 = y - (fj - t), z0 = z - (fk - t), w0 = w - (fl - t);
+
+    const int rx = (x0 > y0) + (x0 > z0) + (x0 > w0);
+    const int ry = (y0 >= x0) + (y0 > z0) + (y0 > w0);
+    const int rz = (z0 >= x0) + (z0 >= y0) + (z0 > w0);
+    const int rw = (w0 >= x0) + (w0 >= y0) + (w0 >= z0);
+
+    const int ii = static_cast<int>(fi) & 255, jj = static_cast<int>(fj) & 255;
+    const int kk = static_cast<int>(fk) & 255, ll = static_cast<int>(fl) & 255;
+    float sum = 0.0f;
+    for (int c = 0; c <= 4; c++) {
+        // Corner c steps along the axes of rank >= 4 - c
+        const int i = rx >= 4 - c, j = ry >= 4 - c, k = rz >= 4 - c, l = rw >= 4 - c;
+        const float cx = x0 - i + c * kG4, cy = y0 - j + c * kG4, cz = z0 - k + c * kG4, cw = w0 - l + c * kG4;
+        const int g = perm[ii + i + perm[jj + j + perm[kk + k + perm[ll + l]]]] & 31;
+        sum += falloff(0.6f - cx * cx - cy * cy - cz * cz - cw * cw) *
+            (kGrad4[0][g] * cx + kGrad4[1][g] * cy + kGrad4[2][g] * cz + kGrad4[3][g] * cw);
+    }
+    return 27.0f * sum;
+}
+
+// 2D Simplex noise and its gradient. Each corner contributes t^4 (g . d) with t = 0.5 - |d|^2,
+// whose derivative is t^4 g - 8 t^3 (g . d) d.
+const float kGrad2[2][8] = {
+    { 1, -1, 1, -1, 1, -1, 0, 0 },
+    { 1, 1, -1, -1, 0, 0, 1, -1 }
+};
+
+float simplex2Grad(const int* perm, float x, float y, float& dx, float& dy) {
+    const float s = (x + y) * kF2;
+    const float fi = std::floor(x + s), fj = std::floor(y + s);
+    const float t = (fi + fj) * kG2;
+    const float x0 = x - (fi - t), y0 = y - (fj - t);
+    const int i1 = x0 > y0, j1 = 1 - i1;
+
+    const int ii = static_cast<int>(fi) & 255, jj = static_cast<int>(fj) & 255;
+    const int g[3] = {
+        perm[ii + perm[jj]] & 7,
+        perm[ii + i1 + perm[jj + j1]] & 7,
+        perm[ii + 1 + perm[jj + 1]] & 7
+    };
+    const float cx[3] = { x0, x0 - i1 + kG2, x0 - 1 + 2 * kG2 };
+    const float cy[3] = { y0, y0 - j1 + kG2, y0 - 1 + 2 * kG2 };
+
+    float n = 0.0f;
+    dx = 0.0f;
+    dy = 0.0f;
+    for (int c = 0; c < 3; c++) {
+        const float gx = kGrad2[0][g[c]], gy = kGrad2[1][g[c]];
+        const float tc = std::max(0.5f - cx[c] * cx[c] - cy[c] * cy[c], 0.0f);
+        const float t2 = tc * tc;
+        const float dot = gx * cx[c] + gy * cy[c];
+        n += t2 * t2 * dot;
+        dx += t2 * t2 * gx - 8.0f * t2 * tc * dot * cx[c];
+        dy += t2 * t2 * gy - 8.0f * t2 * tc * dot * cy[c];
+    }
+    dx *= 70.0f;
+    dy *= 70.0f;
+    return 70.0f * n;
+}
+
+#if defined(__AVX2__)
+
+// 2D Simplex noise with gradient, 8 points per iteration (also used by AVX-512 builds)
+std::size_t simplexGradBatchSimd(const int* perm, const float* xs, const float* ys, float* out, float* dxs, float* dys, std::size_t count) {
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i seven = _mm256_set1_epi32(7);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 G2 = _mm256_set1_ps(kG2);
+    const __m256 gxTable = _mm256_setr_ps(1, -1, 1, -1, 1, -1, 0, 0);
+    const __m256 gyTable = _mm256_setr_ps(1, 1, -1, -1, 0, 0, 1, -1);
+    std::size_t n = 0;
+    for (; n + 8 <= count; n += 8) {
+        const __m256 x = _mm256_loadu_ps(xs + n);
+        const __m256 y = _mm256_loadu_ps(ys + n);
+        const __m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), _mm256_set1_ps(kF2));
+        const __m256 fi = _mm256_floor_ps(_mm256_add_ps(x, s));
+        const __m256 fj = _mm256_floor_ps(_mm256_add_ps(y, s));
+        const __m256 t = _mm256_mul_ps(_mm256_add_ps(fi, fj), G2);
+        const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(fi, t));
+        const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(fj, t));
+
+        const __m256 i1 = _mm256_and_ps(_mm256_cmp_ps(x0, y0, _CMP_GT_OQ), _mm256_set1_ps(1.0f));
+        const __m256 j1 = _mm256_sub_ps(_mm256_set1_ps(1.0f), i1);
+        const __m256 cx[3] = { x0, _mm256_add_ps(_mm256_sub_ps(x0, i1), G2),
+                               _mm256_add_ps(_mm256_sub_ps(x0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2.0f * kG2)) };
+        const __m256 cy[3] = { y0, _mm256_add_ps(_mm256_sub_ps(y0, j1), G2),
+                               _mm256_add_ps(_mm256_sub_ps(y0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2.0f * kG2)) };
+
+        const __m256i ii = _mm256_and_si256(_mm256_cvtps_epi32(fi), mask);
+        const __m256i jj = _mm256_and_si256(_mm256_cvtps_epi32(fj), mask);
+        const __m256i ii1 = _mm256_add_epi32(ii, _mm256_cvtps_epi32(i1));
+        const __m256i jj1 = _mm256_add_epi32(jj, _mm256_cvtps_epi32(j1));
+        const __m256i g[3] = {
+            _mm256_and_si256(_mm256_i32gather_epi32(perm, _mm256_add_epi32(ii, _mm256_i32gather_epi32(perm, jj, 4)), 4), seven),
+            _mm256_and_si256(_mm256_i32gather_epi32(perm, _mm256_add_epi32(ii1, _mm256_i32gather_epi32(perm, jj1, 4)), 4), seven),
+            _mm256_and_si256(_mm256_i32gather_epi32(perm, _mm256_add_epi32(_mm256_add_epi32(ii, one),
+                _mm256_i32gather_epi32(perm, _mm256_add_epi32(jj, one), 4)), 4), seven)
+        };
+
+        __m256 sum = _mm256_setzero_ps(), dx = _mm256_setzero_ps(), dy = _mm256_setzero_ps();
+        for (int c = 0; c < 3; c++) {
+            const __m256 gx = _mm256_permutevar8x32_ps(gxTable, g[c]);
+            const __m256 gy = _mm256_permutevar8x32_ps(gyTable, g[c]);
+            __m256 tc = _mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_add_ps(_mm256_mul_ps(cx[c], cx[c]), _mm256_mul_ps(cy[c], cy[c])));
+            tc = _mm256_max_ps(tc, _mm256_setzero_ps());
+            const __m256 t2 = _mm256_mul_ps(tc, tc);
+            const __m256 t4 = _mm256_mul_ps(t2, t2);
+            const __m256 dot = _mm256_add_ps(_mm256_mul_ps(gx, cx[c]), _mm256_mul_ps(gy, cy[c]));
+            // -8 t^3 (g . d), shared by both components
+            const __m256 k = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(-8.0f), _mm256_mul_ps(t2, tc)), dot);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(t4, dot));
+            dx = _mm256_add_ps(dx, _mm256_add_ps(_mm256_mul_ps(t4, gx), _mm256_mul_ps(k, cx[c])));
+            dy = _mm256_add_ps(dy, _mm256_add_ps(_mm256_mul_ps(t4, gy), _mm256_mul_ps(k, cy[c])));
+        }
+        const __m256 scale = _mm256_set1_ps(70.0f);
+        _mm256_storeu_ps(out + n, _mm256_mul_ps(sum, scale));
+        _mm256_storeu_ps(dxs + n, _mm256_mul_ps(dx, scale));
+        _mm256_storeu_ps(dys + n, _mm256_mul_ps(dy, scale));
+    }
+    return n;
+}
+
+// 3D and 4D kernels, 8 points per iteration (also used by AVX-512 builds)
+
+inline __m256 falloff8(__m256 t) {
+    t = _mm256_max_ps(t, _mm256_setzero_ps());
+    t = _mm256_mul_ps(t, t);
+    return _mm256_mul_ps(t, t);
+}
+
+// Rank of `a` among the other coordinates: ties go to the earlier axis, as in the scalar code
+inline __m256i beats(__m256 a, __m256 b, bool earlier) {
+    return _mm256_castps_si256(_mm256_cmp_ps(a, b, earlier ? _CMP_GT_OQ : _CMP_GE_OQ));
+}
+
+// Offsets (0 or 1) of the axes whose rank is at least `r`
+inline __m256i step8(__m256i rank, int r) {
+    return _mm256_and_si256(_mm256_cmpgt_epi32(rank, _mm256_set1_epi32(r - 1)), _mm256_set1_epi32(1));
+}
+
+// perm[a + b]
+inline __m256i hash8(const int* perm, __m256i a, __m256i b) {
+    return _mm256_i32gather_epi32(perm, _mm256_add_epi32(a, b), 4);
+}
+
+std::size_t simplex3BatchSimd(const int* perm, const float* xs, const float* ys, const float* zs, float* out, std::size_t count) {
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i fifteen = _mm256_set1_epi32(15);
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t n = 0;
+    for (; n + 8 <= count; n += 8) {
+        const __m256 x = _mm256_loadu_ps(xs + n);
+        const __m256 y = _mm256_loadu_ps(ys + n);
+        const __m256 z = _mm256_loadu_ps(zs + n);
+        const __m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), _mm256_set1_ps(kF3));
+        const __m256 fi = _mm256_floor_ps(_mm256_add_ps(x, s));
+        const __m256 fj = _mm256_floor_ps(_mm256_add_ps(y, s));
+        const __m256 fk = _mm256_floor_ps(_mm256_add_ps(z, s));
+        const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(fi, fj), fk), _mm256_set1_ps(kG3));
+        const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(fi, t));
+        const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(fj, t));
+        const __m256 z0 = _mm256_sub_ps(z, _mm256_sub_ps(fk, t));
+
+        // Comparison masks are -1, so the ranks are negated sums
+        const __m256i rx = _mm256_sub_epi32(zero, _mm256_add_epi32(beats(x0, y0, true), beats(x0, z0, true)));
+        const __m256i ry = _mm256_sub_epi32(zero, _mm256_add_epi32(beats(y0, x0, false), beats(y0, z0, true)));
+        const __m256i rz = _mm256_sub_epi32(zero, _mm256_add_epi32(beats(z0, x0, false), beats(z0, y0, false)));
+
+        const __m256i ii = _mm256_and_si256(_mm256_cvtps_epi32(fi), mask);
+        const __m256i jj = _mm256_and_si256(_mm256_cvtps_epi32(fj), mask);
+        const __m256i kk = _mm256_and_si256(_mm256_cvtps_epi32(fk), mask);
+
+        __m256 sum = _mm256_setzero_ps();
+        for (int c = 0; c < 4; c++) {
+            const __m256i i = c == 0 ? zero : step8(rx, 3 - c);
+            const __m256i j = c == 0 ? zero : step8(ry, 3 - c);
+            const __m256i k = c == 0 ? zero : step8(rz, 3 - c);
+            const __m256 off = _mm256_set1_ps(c * kG3);
+            const __m256 cx = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_cvtepi32_ps(i)), off);
+            const __m256 cy = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_cvtepi32_ps(j)), off);
+            const __m256 cz = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_cvtepi32_ps(k)), off);
+
+            __m256i h = _mm256_i32gather_epi32(perm, _mm256_add_epi32(kk, k), 4);
+            h = hash8(perm, _mm256_add_epi32(jj, j), h);
+            h = hash8(perm, _mm256_add_epi32(ii, i), h);
+            const __m256i g = _mm256_and_si256(h, fifteen);
+
+            const __m256 r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cy, cy)), _mm256_mul_ps(cz, cz));
+            const __m256 dot = _mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(_mm256_i32gather_ps(kGrad3[0], g, 4), cx),
+                _mm256_mul_ps(_mm256_i32gather_ps(kGrad3[1], g, 4), cy)),
+                _mm256_mul_ps(_mm256_i32gather_ps(kGrad3[2], g, 4), cz));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(falloff8(_mm256_sub_ps(_mm256_set1_ps(0.6f), r2)), dot));
+        }
+        _mm256_storeu_ps(out + n, _mm256_mul_ps(sum, _mm256_set1_ps(32.0f)));
+    }
+    return n;
+}
+
+std::size_t simplex4BatchSimd(const int* perm, const float* xs, const float* ys, const float* zs, const float* ws, float* out, std::size_t count) {
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i thirtyOne = _mm256_set1_epi32(31);
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t n = 0;
+    for (; n + 8 <= count; n += 8) {
+        const __m256 x = _mm256_loadu_ps(xs + n);
+        const __m256 y = _mm256_loadu_ps(ys + n);
+        const __m256 z = _mm256_loadu_ps(zs + n);
+        const __m256 w = _mm256_loadu_ps(ws + n);
+        const __m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), _mm256_add_ps(z, w)), _mm256_set1_ps(kF4));
+        const __m256 fi = _mm256_floor_ps(_mm256_add_ps(x, s));
+        const __m256 fj = _mm256_floor_ps(_mm256_add_ps(y, s));
+        const __m256 fk = _mm256_floor_ps(_mm256_add_ps(z, s));
+        const __m256 fl = _mm256_floor_ps(_mm256_add_ps(w, s));
+        const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(fi, fj), _mm256_add_ps(fk, fl)), _mm256_set1_ps(kG4));
+        const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(fi, t));
+        const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(fj, t));
+        const __m256 z0 = _mm256_sub_ps(z, _mm256_sub_ps(fk, t));
+        const __m256 w0 = _mm256_sub_ps(w, _mm256_sub_ps(fl, t));
+
+        const __m256i rx = _mm256_sub_epi32(zero, _mm256_add_epi32(_mm256_add_epi32(
+            beats(x0, y0, true), beats(x0, z0, true)), beats(x0, w0, true)));
+        const __m256i ry = _mm256_sub_epi32(zero, _mm256_add_epi32(_mm256_add_epi32(
+            beats(y0, x0, false), beats(y0, z0, true)), beats(y0, w0, true)));
+        const __m256i rz = _mm256_sub_epi32(zero, _mm256_add_epi32(_mm256_add_epi32(
+            beats(z0, x0, false), beats(z0, y0, false)), beats(z0, w0, true)));
+        const __m256i rw = _mm256_sub_epi32(zero, _mm256_add_epi32(_mm256_add_epi32(
+            beats(w0, x0, false), beats(w0, y0, false)), beats(w0, z0, false)));
+
+        const __m256i ii = _mm256_and_si256(_mm256_cvtps_epi32(fi), mask);
+        const __m256i jj = _mm256_and_si256(_mm256_cvtps_epi32(fj), mask);
+        const __m256i kk = _mm256_and_si256(_mm256_cvtps_epi32(fk), mask);
+        const __m256i ll = _mm256_and_si256(_mm256_cvtps_epi32(fl), mask);
+
+        __m256 sum = _mm256_setzero_ps();
+        for (int c = 0; c <= 4; c++) {
+            const __m256i i = c == 0 ? zero : step8(rx, 4 - c);
+            const __m256i j = c == 0 ? zero : step8(ry, 4 - c);
+            const __m256i k = c == 0 ? zero : step8(rz, 4 - c);
+            const __m256i l = c == 0 ? zero : step8(rw, 4 - c);
+            const __m256 off = _mm256_set1_ps(c * kG4);
+            const __m256 cx = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_cvtepi32_ps(i)), off);
+            const __m256 cy = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_cvtepi32_ps(j)), off);
+            const __m256 cz = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_cvtepi32_ps(k)), off);
+            const __m256 cw = _mm256_add_ps(_mm256_sub_ps(w0, _mm256_cvtepi32_ps(l)), off);
+
+            __m256i h = _mm256_i32gather_epi32(perm, _mm256_add_epi32(ll, l), 4);
+            h = hash8(perm, _mm256_add_epi32(kk, k), h);
+            h = hash8(perm, _mm256_add_epi32(jj, j), h);
+            h = hash8(perm, _mm256_add_epi32(ii, i), h);
+            const __m256i g = _mm256_and_si256(h, thirtyOne);
+
+            const __m256 r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cy, cy)),
+                                            _mm256_add_ps(_mm256_mul_ps(cz, cz), _mm256_mul_ps(cw, cw)));
+            const __m256 dot = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(kGrad4[0], g, 4), cx),
+                              _mm256_mul_ps(_mm256_i32gather_ps(kGrad4[1], g, 4), cy)),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(kGrad4[2], g, 4), cz),
+                              _mm256_mul_ps(_mm256_i32gather_ps(kGrad4[3], g, 4), cw)));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(falloff8(_mm256_sub_ps(_mm256_set1_ps(0.6f), r2)), dot));
+        }
+        _mm256_storeu_ps(out + n, _mm256_mul_ps(sum, _mm256_set1_ps(27.0f)));
+    }
+    return n;
+}
+
+#else
+
+std::size_t simplexGradBatchSimd(const int*, const float*, const float*, float*, float*, float*, std::size_t) { return 0; }
+std::size_t simplex3BatchSimd(const int*, const float*, const float*, const float*, float*, std::size_t) { return 0; }
+std::size_t simplex4BatchSimd(const int*, const float*, const float*, const float*, const float*, float*, std::size_t) { return 0; }
+
+#endif
+
+// Entries of the color tables, over the noise value quantized in [0, 1]
+constexpr int kColorLevels = 4096;
+
+inline int colorIndex(float n) {
+    return static_cast<int>(std::min(std::max(n, 0.0f), 1.0f) * (kColorLevels - 1) + 0.5f);
+}
+
+// Color mapping of each mode, evaluated once per table entry instead of once per pixel
+template <int Mode>
+void buildColorTable(unsigned char* table) {
+    for (int k = 0; k < kColorLevels; k++) {
+        float n = k / static_cast<float>(kColorLevels - 1);
+        unsigned char r, g, b, a = 255;
+        if constexpr (Mode == 0) {
+            r = g = b = a = static_cast<unsigned char>(n * 255);
+        } else if constexpr (Mode == 1) {
+            // Clamped: at the peaks of sin/cos the value reaches 256
+            r = static_cast<unsigned char>(std::min(std::sin(n * 6.28f) * 128 + 128, 255.0f));  // Red
+            g = static_cast<unsigned char>(std::min(std::cos(n * 6.28f) * 128 + 128, 255.0f));  // Green
+            b = static_cast<unsigned char>(std::min(std::sin(n * 3.14f) * 128 + 128, 255.0f)); // Blue
+        } else if constexpr (Mode == 2) {
+            unsigned char color = static_cast<unsigned char>(std::min((n + 1.0f) * 128, 255.0f));
+            r = color;               // R
+            g = 255 - color;         // G (invertido)
+            b = (color + 128) % 256; // B (variando)
+        } else {
+            r = static_cast<unsigned char>(255 * (n > 0.5f ? (1 - n) : n));
+            g = static_cast<unsigned char>(255 * (n));
+            b = static_cast<unsigned char>(255 * (1 - std::fabs(n - 0.5f)));
+        }
+        table[k * 4] = r;
+        table[k * 4 + 1] = g;
+        table[k * 4 + 2] = b;
+        table[k * 4 + 3] = a;
+    }
+}
+
+const std::add_pointer_t<void(unsigned char*)> kColorTableBuilders[4] = {
+    buildColorTable<0>, buildColorTable<1>, buildColorTable<2>, buildColorTable<3>
+};
+
+// Colors a row of noise values through a color table. AVX2 builds look up eight pixels per
+// instruction: each RGBA entry is one 32-bit gather.
+void remapRow(const float* ns, unsigned int count, const unsigned char* table, unsigned char* out) {
+    unsigned int s = 0;
+#if defined(__AVX2__)
+    const __m256 levels = _mm256_set1_ps(static_cast<float>(kColorLevels - 1));
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (; s + 8 <= count; s += 8) {
+        const __m256 n = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(ns + s), zero), one);
+        const __m256i k = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(n, levels), half));
+        const __m256i c = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), k, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + s * 4), c);
+    }
+#endif
+    for (; s < count; s++) {
+        std::memcpy(out + s * 4, table + colorIndex(ns[s]) * 4, 4);
+    }
+}
+
+// Octaves of a fractal sum
+constexpr int kMaxOctaves = 16;
+// Each octave is shifted so that the lattices of different octaves do not line up at the origin
+constexpr float kOctaveShift = 37.13f;
+// Noise evaluations (samples x octaves) per thread below which a region is not split
+constexpr unsigned int kParallelGrain = 1u << 15;
+// Offsets that decorrelate the warp levels and the two fields of a level
+constexpr float kWarpShift = 91.7f;
+constexpr float kWarpFieldX = 5.2f;
+constexpr float kWarpFieldY = 1.3f;
+
+struct OctavePlan {
+    int count;                      // Octaves evaluated
+    float frequency[kMaxOctaves];
+    float amplitude[kMaxOctaves];
+    float norm;                     // 1 / total amplitude of the configured octaves
+    float evaluatedNorm;            // 1 / total amplitude of the evaluated octaves
+};
+
+// `footprint` is the distance between samples in noise units. Octaves with a wavelength shorter
+// than two samples are dropped, as are the last ones when `detail` asks for a preview. A nonzero
+// `period` (tileable images spanning `period` cells) snaps each frequency to a whole number of
+// cells per period, `f = round(period * lacunarity^o) / period`, so every octave wraps too.
+OctavePlan planOctaves(int octaves, float lacunarity, float gain, float footprint, float detail, int period = 0) {
+    OctavePlan plan;
+    const int wanted = std::min(octaves, std::max(1, static_cast<int>(std::ceil(octaves * detail))));
+    const float maxFrequency = 0.5f / footprint;
+    float frequency = 1.0f, amplitude = 1.0f, total = 0.0f, evaluated = 0.0f;
+    plan.count = 0;
+    for (int o = 0; o < octaves; o++) {
+        if (o < wanted && (o == 0 || frequency <= maxFrequency)) {
+            plan.frequency[plan.count] = period > 0
+                ? static_cast<float>(std::max(std::lround(period * static_cast<double>(frequency)), 1L)) / period
+                : frequency;
+            plan.amplitude[plan.count] = amplitude;
+            plan.count++;
+            evaluated += amplitude;
+        }
+        total += amplitude;
+        frequency *= lacunarity;
+        amplitude *= gain;
+    }
+    plan.norm = 1.0f / total;
+    plan.evaluatedNorm = 1.0f / evaluated;
+    return plan;
+}
+
+// Evaluates a row of samples at `(xs, ys)`, summing the octaves of the plan into `out`.
+// `eval(xs, ys, out, count, frequency, shift)` samples the noise; the last two arguments let
+// extra axes (such as time) follow the octave. `unitRange` noise (Perlin, in [0, 1]) is
+// centered before the sum and fBm is mapped back. `scratch` holds 3 * count floats.
+template <typename Eval>
+void fractalRow(Eval eval, NoiseFractal type, const OctavePlan& plan, bool unitRange,
+    const float* xs, const float* ys, float* out, unsigned int count, float* scratch)
+{
+    float* px = scratch;
+    float* py = scratch + count;
+    float* pn = scratch + 2 * count;
+    if (type == NoiseFractal::None) {
+        eval(xs, ys, out, count, 1.0f, 0.0f);
+        return;
+    }
+
+    const float center = unitRange ? 2.0f : 1.0f;
+    const float offset = unitRange ? -1.0f : 0.0f;
+    std::fill(out, out + count, 0.0f);
+    for (int o = 0; o < plan.count; o++) {
+        const float f = plan.frequency[o];
+        const float a = plan.amplitude[o];
+        const float shift = o * kOctaveShift;
+        for (unsigned int s = 0; s < count; s++) {
+            px[s] = xs[s] * f + shift;
+            py[s] = ys[s] * f + shift;
+        }
+        eval(px, py, pn, count, f, shift);
+
+        if (type == NoiseFractal::FBm) {
+            for (unsigned int s = 0; s < count; s++) out[s] += a * (pn[s] * center + offset);
+        } else if (type == NoiseFractal::Turbulence) {
+            for (unsigned int s = 0; s < count; s++) out[s] += a * std::fabs(pn[s] * center + offset);
+        } else {
+            for (unsigned int s = 0; s < count; s++) {
+                const float r = 1.0f - std::fabs(pn[s] * center + offset);
+                out[s] += a * r * r;
+            }
+        }
+    }
+
+    // Skipped octaves still count in fBm, which keeps its contrast since their average is zero.
+    // Turbulence and ridged octaves average above zero, so they are normalized by the octaves
+    // evaluated instead: a preview or a zoomed-out view keeps the brightness of the full sum.
+    if (type == NoiseFractal::FBm) {
+        for (unsigned int s = 0; s < count; s++) {
+            out[s] = unitRange ? out[s] * plan.norm * 0.5f + 0.5f : out[s] * plan.norm;
+        }
+    } else {
+        for (unsigned int s = 0; s < count; s++) out[s] *= plan.evaluatedNorm;
+    }
+}
 
-    for (int i = 0; i < 256; i++) {
-        p[i] = dis(gen);  
+// Octave plans of the warp fields. Their samples are `frequency` times denser in noise space.
+// A nonzero `period` snaps their octaves as planOctaves() does, over the `period * frequency`
+// cells that each field spans across a tile.
+std::vector<OctavePlan> planWarp(const std::vector<WarpLevel>& levels, float footprint, float detail, int period = 0) {
+    std::vector<OctavePlan> plans;
+    for (const WarpLevel& level : levels) {
+        const int cells = period > 0 ? static_cast<int>(std::max(std::lround(period * static_cast<double>(level.frequency)), 1L)) : 0;
+        plans.push_back(planOctaves(level.octaves, 2.0f, 0.5f, footprint * level.frequency, detail, cells));
     }
+    return plans;
+}
 
-    for (int i = 0; i < 256; i++) {
-        p[i + 256] = p[i];
+// Noise evaluations per sample of the warp levels
+unsigned int warpWork(const std::vector<OctavePlan>& plans) {
+    unsigned int work = 0;
+    for (const OctavePlan& plan : plans) {
+        work += 2 * plan.count;
     }
+    return work;
 }
 
-float PerlinNoise::noise(float x, float y) {
-    int X = static_cast<int>(floor(x)) & 255;
-    int Y = static_cast<int>(floor(y)) & 255;
+// Displaces a row of points through the warp levels, innermost first. `warped` receives the x
+// then the y coordinates (2 * count floats); `scratch` holds 7 * count floats.
+template <typename Eval>
+void warpRow(Eval eval, const std::vector<WarpLevel>& levels, const std::vector<OctavePlan>& plans,
+    bool unitRange, const float* xs, const float* ys, float* warped, unsigned int count, float* scratch)
+{
+    float* qx = warped;
+    float* qy = warped + count;
+    float* tx = scratch;
+    float* ty = scratch + count;
+    float* a = scratch + 2 * count;
+    float* b = scratch + 3 * count;
+    std::copy(xs, xs + count, qx);
+    std::copy(ys, ys + count, qy);
+    for (std::size_t l = 0; l < levels.size(); l++) {
+        const float frequency = levels[l].frequency;
+        const float shift = (l + 1) * kWarpShift;
+        auto field = [&](const float* px, const float* py, float* pn, unsigned int n, float f, float octaveShift) {
+            eval(px, py, pn, n, f * frequency, octaveShift);
+        };
+        for (unsigned int s = 0; s < count; s++) {
+            tx[s] = qx[s] * frequency + shift;
+            ty[s] = qy[s] * frequency + shift;
+        }
+        fractalRow(field, NoiseFractal::FBm, plans[l], unitRange, tx, ty, a, count, scratch + 4 * count);
+        for (unsigned int s = 0; s < count; s++) {
+            tx[s] += kWarpFieldX;
+            ty[s] += kWarpFieldY;
+        }
+        fractalRow(field, NoiseFractal::FBm, plans[l], unitRange, tx, ty, b, count, scratch + 4 * count);
+
+        // Unit-range fields (Perlin) are centered so that the displacement averages zero
+        const float amplitude = unitRange ? 2.0f * levels[l].amplitude : levels[l].amplitude;
+        const float bias = unitRange ? -levels[l].amplitude : 0.0f;
+        for (unsigned int s = 0; s < count; s++) {
+            qx[s] = xs[s] + a[s] * amplitude + bias;
+            qy[s] = ys[s] + b[s] * amplitude + bias;
+        }
+    }
+}
+
+// Minimum rows per thread for a row of `work` noise evaluations
+unsigned int rowGrain(unsigned int work) {
+    return kParallelGrain / std::max(work, 1u) + 1;
+}
+
+}
+
+PerlinNoise::PerlinNoise(unsigned int w, unsigned int h, unsigned int s) {
+    width = w;
+    height = h;
+    scale = 20;
+    mode = 2;
+    colorTableMode = -1;
+    fractal = NoiseFractal::None;
+    octaves = 6;
+    lacunarity = 2.0f;
+    gain = 0.5f;
+    tileable = false;
+    lattice = NoiseLattice::Permutation;
+    latticeSeed = 0;
+    originX = 0.0;
+    originY = 0.0;
+    fieldDirty = true;
+    setSeed(s);
+}
+
+float PerlinNoise::noise(float x, float y, int periodX, int periodY) {
+    // Lattice cells wrap modulo the period (0 is unbounded). The permutation table only holds
+    // 256 cells, so longer periods are evaluated on the hashed lattice.
+    x = std::min(std::max(x, -kMaxLatticeCell), kMaxLatticeCell);
+    y = std::min(std::max(y, -kMaxLatticeCell), kMaxLatticeCell);
+    int X = static_cast<int>(floor(x));
+    int Y = static_cast<int>(floor(y));
+    int X1 = static_cast<int>(static_cast<unsigned int>(X) + 1u);
+    int Y1 = static_cast<int>(static_cast<unsigned int>(Y) + 1u);
+    if (periodX > 0) {
+        X %= periodX;
+        Y %= periodY;
+        if (X < 0) X += periodX;
+        if (Y < 0) Y += periodY;
+        X1 = X + 1 == periodX ? 0 : X + 1;
+        Y1 = Y + 1 == periodY ? 0 : Y + 1;
+    }
 
     float xf = x - floor(x);
     float yf = y - floor(y);
@@ -34,79 +953,202 @@ float PerlinNoise::noise(float x, float y) {
     float u = fade(xf);
     float v = fade(yf);
 
-    int aa = p[X] + Y;
-    int ab = p[X] + Y + 1;
-    int ba = p[X + 1] + Y;
-    int bb = p[X + 1] + Y + 1;
+    int haa, hab, hba, hbb;
+    if (hashedLattice(periodX, periodY)) {
+        haa = static_cast<int>(latticeHash(latticeSeed, X, Y) & 15);
+        hab = static_cast<int>(latticeHash(latticeSeed, X, Y1) & 15);
+        hba = static_cast<int>(latticeHash(latticeSeed, X1, Y) & 15);
+        hbb = static_cast<int>(latticeHash(latticeSeed, X1, Y1) & 15);
+    } else {
+        haa = p[p[X] + Y];
+        hab = p[p[X] + Y1];
+        hba = p[p[X1] + Y];
+        hbb = p[p[X1] + Y1];
+    }
 
-    float x1 = lerp(grad(p[aa], xf, yf), grad(p[ba], xf - 1, yf), u);
-    float x2 = lerp(grad(p[ab], xf, yf - 1), grad(p[bb], xf - 1, yf - 1), u);
+    float x1 = lerp(grad(haa, xf, yf), grad(hba, xf - 1, yf), u);
+    float x2 = lerp(grad(hab, xf, yf - 1), grad(hbb, xf - 1, yf - 1), u);
 
     return (lerp(x1, x2, v) + 1) / 2; 
 }
 
  std::vector<unsigned char> PerlinNoise::generateImage(std::string &imageName)
  {
-     std::vector<unsigned char> i(width * height * 4); // 4 channels: RGBA
-    if (mode > 3) mode = 0;
-    unsigned char color = 0;
-    unsigned char r = 0;
-    unsigned char g = 0;
-    unsigned char b = 0;
-    for (unsigned int y = 0; y < height; y++) {
-        float ny = y / static_cast<float>(height) * scale;
-        for (unsigned int x = 0; x < width; x++) {
-            float nx = x / static_cast<float>(width) * scale; 
-            float n = noise(nx, ny);
-            switch (mode)
-            {
-            case 0:
-                color = static_cast<unsigned char>(n * 255);
-                i[(y * width + x) * 4] = color;     // R
-                i[(y * width + x) * 4 + 1] = color; // G
-                i[(y * width + x) * 4 + 2] = color; // B
-                i[(y * width + x) * 4 + 3] = color;   // A 
-                break;
-            case 1:
-
-                r = static_cast<unsigned char>(std::sin(n * 6.28f) * 128 + 128);  // Red
-                g = static_cast<unsigned char>(std::cos(n * 6.28f) * 128 + 128);  // Green
-                b = static_cast<unsigned char>(std::sin(n * 3.14f) * 128 + 128); // Blue
-
-                i[(y * width + x) * 4] = r;       // R
-                i[(y * width + x) * 4 + 1] = g;   // G
-                i[(y * width + x) * 4 + 2] = b;
-                i[(y * width + x) * 4 + 3] = 255;
-                break;
-            case 2:
-                color = static_cast<unsigned char>((n + 1.0f) * 128);
-
-                i[(y * width + x) * 4] = color;       // R
-                i[(y * width + x) * 4 + 1] = 255 - color; // G (invertido)
-                i[(y * width + x) * 4 + 2] = (color + 128) % 256; // B (variando)
-                i[(y * width + x) * 4 + 3] = 255;     // A (opacidad)
-                break;
-            case 3:
-                r = static_cast<unsigned char>(255 * (n > 0.5f ? (1 - n) : n));
-                g = static_cast<unsigned char>(255 * (n));
-                b = static_cast<unsigned char>(255 * (1 - std::fabs(n - 0.5f)));
-
-                i[(y * width + x) * 4] = r;       // R
-                i[(y * width + x) * 4 + 1] = g;   // G
-                i[(y * width + x) * 4 + 2] = b;
-                i[(y * width + x) * 4 + 3] = 255;
-                break;
-            default:
-                break;
+    std::vector<unsigned char> i(width * height * 4); // 4 channels: RGBA
+    updateField();
+    renderRegion(i, 0, 0, width, height);
+
+    imageName = "../assets/simplex_noise_" + generateUniqueFileName();
+
+    return i;
+ }
+
+void PerlinNoise::noiseBatch(const float* xs, const float* ys, float* out, std::size_t count)
+{
+    // The permutation lattice repeats every 256 cells; the hashed one does not repeat
+    const int period = lattice == NoiseLattice::Hash ? 0 : 256;
+    noiseBatchPeriodic(xs, ys, out, count, period, period);
+}
+
+void PerlinNoise::setSeed(unsigned int s)
+{
+    seed = s;
+    p = s == 0 ? kDefaultPermutation : makePermutation(s);
+    latticeSeed = s;
+    fieldDirty = true;
+}
+
+void PerlinNoise::setLattice(NoiseLattice type, unsigned int seed)
+{
+    lattice = type;
+    latticeSeed = seed;
+    fieldDirty = true;
+}
+
+void PerlinNoise::noiseBatchPeriodic(const float* xs, const float* ys, float* out, std::size_t count, int periodX, int periodY)
+{
+    std::size_t done = hashedLattice(periodX, periodY)
+        ? perlinBatchSimd<true>(p.data(), latticeSeed, xs, ys, out, count, periodX, periodY)
+        : perlinBatchSimd<false>(p.data(), latticeSeed, xs, ys, out, count, periodX, periodY);
+    for (; done < count; done++) {
+        out[done] = noise(xs[done], ys[done], periodX, periodY);
+    }
+}
+
+void PerlinNoise::setFractal(NoiseFractal type, int o, float l, float g)
+{
+    fractal = type;
+    octaves = std::min(std::max(o, 1), kMaxOctaves);
+    lacunarity = l;
+    gain = g;
+    fieldDirty = true;
+}
+
+void PerlinNoise::addWarp(float amplitude, float frequency, int o)
+{
+    warp.push_back({ amplitude, frequency, std::min(std::max(o, 1), kMaxOctaves) });
+    fieldDirty = true;
+}
+
+void PerlinNoise::renderRegion(std::vector<unsigned char>& i, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, float detail)
+{
+    if (mode < 0 || mode > 3) mode = 0;
+
+    // The color mapping of the mode is chosen once and precomputed into a table
+    if (colorTableMode != mode) {
+        colorTable.resize(kColorLevels * 4);
+        kColorTableBuilders[mode](colorTable.data());
+        colorTableMode = mode;
+    }
+    const unsigned char* table = colorTable.data();
+    const unsigned int samples = (x1 - x0 + step - 1) / step;
+
+    // A new mode over unchanged parameters only needs the cached noise remapped
+    if (!fieldDirty) {
+        for (unsigned int y = y0; y < y1; y++) {
+            remapRow(&cachedField[static_cast<std::size_t>(y) * width + x0], x1 - x0, table, &i[(y * width + x0) * 4]);
+        }
+        return;
+    }
+
+    evaluateRegion(x0, y0, x1, y1, step, detail, [&](unsigned int y, const float* ns) {
+        if (step == 1) {
+            remapRow(ns, samples, table, &i[(y * width + x0) * 4]);
+        } else {
+            for (unsigned int s = 0; s < samples; s++) {
+                unsigned int x = x0 + s * step;
+                const unsigned char* c = table + colorIndex(ns[s]) * 4;
+                // Each sample covers a step x step block
+                fillBlock(i, width, x, y, std::min(step, x1 - x), std::min(step, y1 - y), c[0], c[1], c[2], c[3]);
             }
+        }
+    });
+}
+
+std::vector<float> PerlinNoise::generateField()
+{
+    updateField();
+    return cachedField;
+}
 
+void PerlinNoise::updateField()
+{
+    if (!fieldDirty) return;
+    cachedField.resize(static_cast<std::size_t>(width) * height);
+    evaluateRegion(0, 0, width, height, 1, 1.0f, [&](unsigned int y, const float* ns) {
+        std::copy(ns, ns + width, &cachedField[static_cast<std::size_t>(y) * width]);
+    });
+    fieldDirty = false;
+}
+
+void PerlinNoise::renderField(std::vector<float>& field, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1)
+{
+    if (!fieldDirty) {
+        for (unsigned int y = y0; y < y1; y++) {
+            const float* row = &cachedField[static_cast<std::size_t>(y) * width];
+            std::copy(row + x0, row + x1, &field[static_cast<std::size_t>(y) * width + x0]);
         }
+        return;
     }
+    evaluateRegion(x0, y0, x1, y1, 1, 1.0f, [&](unsigned int y, const float* ns) {
+        std::copy(ns, ns + (x1 - x0), &field[static_cast<std::size_t>(y) * width + x0]);
+    });
+}
 
-    imageName = "../assets/simplex_noise_" + generateUniqueFileName();
+void PerlinNoise::evaluateRegion(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1,
+    unsigned int step, float detail, const std::function<void(unsigned int, const float*)>& emit)
+{
+    // Noise is evaluated a row at a time through the batch API
+    const unsigned int samples = (x1 - x0 + step - 1) / step;
+    const unsigned int rows = (y1 - y0 + step - 1) / step;
+    std::vector<float> xs(samples);
+    for (unsigned int s = 0; s < samples; s++) {
+        xs[s] = static_cast<float>((originX + x0 + s * step) / width * scale);
+    }
+    const float footprint = scale * step / static_cast<float>(std::min(width, height));
+    const int period = tileable ? std::max(scale, 1) : 0;
+    const OctavePlan plan = planOctaves(fractal == NoiseFractal::None ? 1 : octaves, lacunarity, gain, footprint, detail, period);
+    // Tileable: each warp field spans a whole number of cells per tile, so the displacement wraps too
+    std::vector<WarpLevel> levels = warp;
+    for (WarpLevel& level : levels) {
+        if (period > 0) {
+            const long cells = std::max(std::lround(period * static_cast<double>(level.frequency)), 1L);
+            level.frequency = static_cast<float>(cells) / period;
+        }
+    }
+    const std::vector<OctavePlan> warpPlans = planWarp(levels, footprint, detail, period);
 
-    return i;
- }
+    // Rows are split across threads; each one keeps only a row of scratch. Warp levels are
+    // evaluated in the same pass, so their fields never leave these buffers.
+    parallelFor(0, rows, rowGrain(samples * (plan.count + warpWork(warpPlans))), [&](unsigned int first, unsigned int last) {
+        std::vector<float> scratch(samples * (levels.empty() ? 3 : 7)), ns(samples), ys(samples);
+        std::vector<float> warped(levels.empty() ? 0 : samples * 2);
+        auto sample = [this](const float* px, const float* py, float* pn, unsigned int n, float f, float) {
+            // Tileable: the image spans `scale` cells, `scale * f` at octave frequency f. The plan
+            // made that a whole number; periods over 256 run on the hashed lattice.
+            if (!tileable) {
+                noiseBatch(px, py, pn, n);
+                return;
+            }
+            const int cells = static_cast<int>(std::min(std::max(std::lround(scale * static_cast<double>(f)), 1L), 1L << 24));
+            noiseBatchPeriodic(px, py, pn, n, cells, cells);
+        };
+        for (unsigned int j = first; j < last; j++) {
+            const unsigned int y = y0 + j * step;
+            std::fill(ys.begin(), ys.end(), static_cast<float>((originY + y) / height * scale));
+            const float* px = xs.data();
+            const float* py = ys.data();
+            if (!levels.empty()) {
+                warpRow(sample, levels, warpPlans, true, xs.data(), ys.data(), warped.data(), samples, scratch.data());
+                px = warped.data();
+                py = warped.data() + samples;
+            }
+            fractalRow(sample, fractal, plan, true, px, py, ns.data(), samples, scratch.data());
+            emit(y, ns.data());
+        }
+    });
+}
 
 float PerlinNoise::fade(float t) {
     return t * t * t * (t * (t * 6 - 15) + 10);
@@ -125,23 +1167,233 @@ float PerlinNoise::grad(int hash, float x, float y) {
 std::vector<unsigned char> SimplexNoise::generateImage(std::string& imageName)
 {
     std::vector<unsigned char> i(width * height * 4);
-    for (int y = 0; y < height; y++) {
-        float ny = y / static_cast<float>(height) * scale;
-        for (int x = 0; x < width; x++) {
-            double nx = x / static_cast<float>(width) * scale;
-            double n = noise(nx, ny);
+    renderRegion(i, 0, 0, width, height);
+    imageName = "../assets/simplex_noise_" + generateUniqueFileName();
+    return i;
+}
+
+void SimplexNoise::noiseBatch(const float* xs, const float* ys, float* out, std::size_t count)
+{
+    std::size_t done = simplexBatchSimd(perm.data(), xs, ys, out, count);
+    for (; done < count; done++) {
+        out[done] = static_cast<float>(noise(xs[done], ys[done]));
+    }
+}
+
+void SimplexNoise::setFractal(NoiseFractal type, int o, float l, float g)
+{
+    fractal = type;
+    octaves = std::min(std::max(o, 1), kMaxOctaves);
+    lacunarity = l;
+    gain = g;
+}
+
+void SimplexNoise::noiseBatchGrad(const float* xs, const float* ys, float* out, float* dx, float* dy, std::size_t count)
+{
+    std::size_t done = simplexGradBatchSimd(perm.data(), xs, ys, out, dx, dy, count);
+    for (; done < count; done++) {
+        out[done] = simplex2Grad(perm.data(), xs[done], ys[done], dx[done], dy[done]);
+    }
+}
+
+void SimplexNoise::noiseBatch3D(const float* xs, const float* ys, const float* zs, float* out, std::size_t count)
+{
+    std::size_t done = simplex3BatchSimd(perm.data(), xs, ys, zs, out, count);
+    for (; done < count; done++) {
+        out[done] = simplex3(perm.data(), xs[done], ys[done], zs[done]);
+    }
+}
+
+void SimplexNoise::noiseBatch4D(const float* xs, const float* ys, const float* zs, const float* ws, float* out, std::size_t count)
+{
+    std::size_t done = simplex4BatchSimd(perm.data(), xs, ys, zs, ws, out, count);
+    for (; done < count; done++) {
+        out[done] = simplex4(perm.data(), xs[done], ys[done], zs[done], ws[done]);
+    }
+}
+
+NoiseVolume SimplexNoise::renderVolume(unsigned int sizeX, unsigned int sizeY, unsigned int sizeZ)
+{
+    constexpr unsigned int brick = NoiseVolume::kBrick;
+    NoiseVolume volume(sizeX, sizeY, sizeZ);
+    const float spacing = static_cast<float>(scale) / width;
+    const OctavePlan plan = planOctaves(fractal == NoiseFractal::None ? 1 : octaves, lacunarity, gain, spacing, 1.0f);
+    const bool positive = fractal == NoiseFractal::Ridged || fractal == NoiseFractal::Turbulence;
+    const float low = positive ? 0.0f : -1.0f;
+    const float quantize = 255.0f / (1.0f - low);
+
+    // Each thread keeps one brick of bytes plus a row of scratch. Edge bricks are evaluated in
+    // full; the voxels past the volume only pad the brick.
+    const unsigned int bricks = volume.bricksX() * volume.bricksY() * volume.bricksZ();
+    parallelFor(0, bricks, 1, [&](unsigned int first, unsigned int last) {
+        std::vector<float> xs(brick), ys(brick), zs(brick), ns(brick), scratch(brick * 3);
+        std::vector<unsigned char> values(brick * brick * brick);
+        float z = 0.0f;
+        auto sample = [&](const float* px, const float* py, float* pn, unsigned int n, float f, float shift) {
+            std::fill(zs.begin(), zs.begin() + n, z * f + shift);
+            noiseBatch3D(px, py, zs.data(), pn, n);
+        };
+        for (unsigned int b = first; b < last; b++) {
+            const unsigned int i = b % volume.bricksX();
+            const unsigned int j = b / volume.bricksX() % volume.bricksY();
+            const unsigned int k = b / (volume.bricksX() * volume.bricksY());
+            for (unsigned int x = 0; x < brick; x++) {
+                xs[x] = (i * brick + x) * spacing;
+            }
+            for (unsigned int vz = 0; vz < brick; vz++) {
+                z = (k * brick + vz) * spacing;
+                for (unsigned int vy = 0; vy < brick; vy++) {
+                    std::fill(ys.begin(), ys.end(), (j * brick + vy) * spacing);
+                    fractalRow(sample, fractal, plan, false, xs.data(), ys.data(), ns.data(), brick, scratch.data());
+                    unsigned char* row = &values[(vz * brick + vy) * brick];
+                    for (unsigned int x = 0; x < brick; x++) {
+                        row[x] = static_cast<unsigned char>(std::min(std::max((ns[x] - low) * quantize + 0.5f, 0.0f), 255.0f));
+                    }
+                }
+            }
+            volume.storeBrick(i, j, k, values.data());
+        }
+    });
+    return volume;
+}
+
+void SimplexNoise::setTime(double t)
+{
+    time = t;
+    animated = true;
+}
+
+void SimplexNoise::setLoop(double period)
+{
+    loopPeriod = period > 0.0 ? period : 0.0;
+}
+
+void SimplexNoise::renderFrame(std::vector<unsigned char>& image, double t, unsigned int step)
+{
+    setTime(t);
+    renderRegion(image, 0, 0, width, height, std::max(step, 1u));
+}
+
+void SimplexNoise::addWarp(float amplitude, float frequency, int o)
+{
+    warp.push_back({ amplitude, frequency, std::min(std::max(o, 1), kMaxOctaves) });
+}
+
+void SimplexNoise::renderRegion(std::vector<unsigned char>& i, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, float detail)
+{
+    const unsigned int samples = (x1 - x0 + step - 1) / step;
+    evaluateRegion(x0, y0, x1, y1, step, detail, [&](unsigned int y, const float* ns) {
+        for (unsigned int s = 0; s < samples; s++) {
+            unsigned int x = x0 + s * step;
+            double n = ns[s];
 
             unsigned char r = static_cast<unsigned char>(255 * (n > 0.5f ? (1 - n) : n));
             unsigned char g = static_cast<unsigned char>(255 * (n));
             unsigned char b = static_cast<unsigned char>(255 * (1 - std::fabs(n - 0.5f)));
 
-            i[(y * width + x) * 4] = r;               i[(y * width + x) * 4 + 1] = g;  
-            i[(y * width + x) * 4 + 2] = b;
-            i[(y * width + x) * 4 + 3] = 255;
+            // Each sample covers a step x step block
+            fillBlock(i, width, x, y, std::min(step, x1 - x), std::min(step, y1 - y), r, g, b, 255);
         }
+    });
+}
+
+std::vector<float> SimplexNoise::generateField()
+{
+    std::vector<float> field(static_cast<std::size_t>(width) * height);
+    renderField(field, 0, 0, width, height);
+    return field;
+}
+
+void SimplexNoise::renderField(std::vector<float>& field, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1)
+{
+    evaluateRegion(x0, y0, x1, y1, 1, 1.0f, [&](unsigned int y, const float* ns) {
+        std::copy(ns, ns + (x1 - x0), &field[static_cast<std::size_t>(y) * width + x0]);
+    });
+}
+
+void SimplexNoise::evaluateRegion(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1,
+    unsigned int step, float detail, const std::function<void(unsigned int, const float*)>& emit)
+{
+    // Noise is evaluated a row at a time through the batch API
+    const unsigned int samples = (x1 - x0 + step - 1) / step;
+    const unsigned int rows = (y1 - y0 + step - 1) / step;
+    std::vector<float> xs(samples);
+    for (unsigned int s = 0; s < samples; s++) {
+        xs[s] = static_cast<float>((originX + x0 + s * step) / width * scale);
     }
-    imageName = "../assets/simplex_noise_" + generateUniqueFileName();
-    return i;
+    const float footprint = static_cast<float>(scale) * step / std::min(width, height);
+    const OctavePlan plan = planOctaves(fractal == NoiseFractal::None ? 1 : octaves, lacunarity, gain, footprint, detail);
+    // The torus of tileable images has no planar coordinates to displace
+    const std::vector<WarpLevel> levels = tileable ? std::vector<WarpLevel>() : warp;
+    const std::vector<OctavePlan> warpPlans = planWarp(levels, footprint, detail);
+
+    // Time axis: a line through 3D noise, or a circle through 4D noise whose circumference
+    // is the loop period, so that time advances at the same speed in both modes
+    const float pi = 3.14159265358979f;
+    const float angle = loopPeriod > 0.0 ? static_cast<float>(2.0 * pi * std::fmod(time, loopPeriod) / loopPeriod) : 0.0f;
+    const float radius = static_cast<float>(loopPeriod / (2.0 * pi));
+    const float tz = loopPeriod > 0.0 ? radius * std::cos(angle) : static_cast<float>(time);
+    const float tw = radius * std::sin(angle);
+
+    // Tileable: the skewed lattice cannot wrap on a square tile, so each image axis becomes a
+    // circle of circumference `scale` and the image is a torus through 4D noise
+    const float torus = static_cast<float>(scale / (2.0 * pi));
+    std::vector<float> cosX(tileable ? samples : 0), sinX(tileable ? samples : 0);
+    for (unsigned int s = 0; s < cosX.size(); s++) {
+        const float a = static_cast<float>(2.0 * pi * std::fmod(originX + x0 + s * step, width) / width);
+        cosX[s] = torus * std::cos(a);
+        sinX[s] = torus * std::sin(a);
+    }
+
+    // Rows are split across threads; each one keeps only a row of scratch. Warp levels are
+    // evaluated in the same pass, so their fields never leave these buffers.
+    parallelFor(0, rows, rowGrain(samples * (plan.count + warpWork(warpPlans))), [&](unsigned int first, unsigned int last) {
+        std::vector<float> scratch(samples * (levels.empty() ? 3 : 7)), ns(samples), ys(samples);
+        std::vector<float> warped(levels.empty() ? 0 : samples * 2);
+        std::vector<float> zs(animated || tileable ? samples : 0), ws(loopPeriod > 0.0 || tileable ? samples : 0);
+        std::vector<float> tx(tileable ? samples : 0), ty(tileable ? samples : 0);
+        float cosY = 0.0f, sinY = 0.0f;
+        auto sample = [&](const float* px, const float* py, float* pn, unsigned int n, float f, float shift) {
+            if (tileable) {
+                for (unsigned int s = 0; s < n; s++) {
+                    tx[s] = cosX[s] * f + shift;
+                    ty[s] = sinX[s] * f + shift;
+                }
+                std::fill(zs.begin(), zs.end(), cosY * f + shift);
+                std::fill(ws.begin(), ws.end(), sinY * f + shift);
+                noiseBatch4D(tx.data(), ty.data(), zs.data(), ws.data(), pn, n);
+                return;
+            }
+            if (!animated) {
+                noiseBatch(px, py, pn, n);
+                return;
+            }
+            std::fill(zs.begin(), zs.end(), tz * f + shift);
+            if (loopPeriod > 0.0) {
+                std::fill(ws.begin(), ws.end(), tw * f + shift);
+                noiseBatch4D(px, py, zs.data(), ws.data(), pn, n);
+            } else {
+                noiseBatch3D(px, py, zs.data(), pn, n);
+            }
+        };
+        for (unsigned int j = first; j < last; j++) {
+            const unsigned int y = y0 + j * step;
+            std::fill(ys.begin(), ys.end(), static_cast<float>((originY + y) / height * scale));
+            const float b = static_cast<float>(2.0 * pi * std::fmod(originY + y, height) / height);
+            cosY = torus * std::cos(b);
+            sinY = torus * std::sin(b);
+            const float* px = xs.data();
+            const float* py = ys.data();
+            if (!levels.empty()) {
+                warpRow(sample, levels, warpPlans, false, xs.data(), ys.data(), warped.data(), samples, scratch.data());
+                px = warped.data();
+                py = warped.data() + samples;
+            }
+            fractalRow(sample, fractal, plan, false, px, py, ns.data(), samples, scratch.data());
+            emit(y, ns.data());
+        }
+    });
 }
 
 double SimplexNoise::noise(double xin, double yin)
@@ -194,18 +1446,8 @@ double SimplexNoise::noise(double xin, double yin)
 	return 70.0 * (n0 + n1 + n2);
 }
 
-void SimplexNoise::initializePermutation()
+void SimplexNoise::setSeed(unsigned int s)
 {
-    perm.resize(512);
-    for (int i = 0; i < 256; ++i) perm[i] = i;
-
-    std::random_device rd; // Semilla
-    std::mt19937 generator(rd());
-    for (int i = 255; i > 0; --i) {
-        std::uniform_int_distribution<int> distribution(0, i);
-        int j = distribution(generator);
-        std::swap(perm[i], perm[j]);
-    }
-
-    for (int i = 0; i < 256; ++i) perm[256 + i] = perm[i];
+    seed = s;
+    perm = s == 0 ? kDefaultPermutation : makePermutation(s);
 }
@@ -0,0 +1,151 @@
+#include "../include/spectral.hpp"
+#include "../include/fft.hpp"
+#include "../include/image_utils.hpp"
+#include "../include/parallel.hpp"
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+namespace {
+
+// Color gradients of the modes: value in [0, 1] followed by RGB
+struct ColorStop {
+    float at;
+    unsigned char r, g, b;
+};
+
+const ColorStop kGray[] = { { 0.0f, 0, 0, 0 }, { 1.0f, 255, 255, 255 } };
+const ColorStop kTerrain[] = {
+    { 0.0f, 10, 30, 90 }, { 0.45f, 40, 90, 170 }, { 0.48f, 210, 200, 150 }, { 0.52f, 80, 150, 60 },
+    { 0.7f, 40, 100, 40 }, { 0.8f, 110, 100, 90 }, { 0.9f, 240, 240, 245 }, { 1.0f, 255, 255, 255 }
+};
+const ColorStop kClouds[] = { { 0.0f, 40, 100, 200 }, { 0.45f, 90, 150, 230 }, { 0.8f, 245, 245, 250 }, { 1.0f, 255, 255, 255 } };
+
+// Rows of bins per thread below which the spectrum is filled on a single thread
+constexpr unsigned int kParallelGrain = 64;
+
+// Integer hash of a frequency bin (the xxHash32 finalizer)
+std::uint32_t binHash(std::uint32_t seed, std::uint32_t kx, std::uint32_t ky) {
+    std::uint32_t h = seed ^ (kx * 0x8da6b343u) ^ (ky * 0xd8163841u);
+    h ^= h >> 15;
+    h *= 0x85ebca77u;
+    h ^= h >> 13;
+    h *= 0xc2b2ae3du;
+    h ^= h >> 16;
+    return h;
+}
+
+template <std::size_t N>
+void colorOf(const ColorStop (&stops)[N], float v, unsigned char* rgb) {
+    std::size_t i = 1;
+    while (i < N - 1 && v > stops[i].at) i++;
+    const ColorStop& a = stops[i - 1];
+    const ColorStop& b = stops[i];
+    const float t = std::min(std::max((v - a.at) / (b.at - a.at), 0.0f), 1.0f);
+    rgb[0] = static_cast<unsigned char>(a.r + (b.r - a.r) * t);
+    rgb[1] = static_cast<unsigned char>(a.g + (b.g - a.g) * t);
+    rgb[2] = static_cast<unsigned char>(a.b + (b.b - a.b) * t);
+}
+
+}
+
+SpectralNoise::SpectralNoise(unsigned int w, unsigned int h)
+    : width(w), height(h)
+{
+    beta = 2.0f;
+    seed = 0;
+    mode = 1;
+    dirty = true;
+}
+
+std::vector<unsigned char> SpectralNoise::generateImage(std::string& imageName)
+{
+    std::vector<unsigned char> image(width * height * 4);
+    renderRegion(image, 0, 0, width, height);
+    imageName = "../assets/spectral_noise_" + generateUniqueFileName();
+    return image;
+}
+
+const std::vector<float>& SpectralNoise::field()
+{
+    if (dirty) {
+        synthesize();
+        dirty = false;
+    }
+    return heights;
+}
+
+void SpectralNoise::synthesize()
+{
+    const unsigned int bins = width / 2 + 1;
+    std::vector<std::complex<float>> spectrum(static_cast<std::size_t>(bins) * height);
+
+    // Frequencies in cycles per pixel, so that the spectrum is isotropic on non-square images
+    const float pi = 3.14159265358979f;
+    parallelFor(0, height, kParallelGrain, [&](unsigned int first, unsigned int last) {
+        for (unsigned int ky = first; ky < last; ky++) {
+            const float fy = (ky <= height / 2 ? static_cast<float>(ky) : static_cast<float>(ky) - height) / height;
+            std::complex<float>* row = &spectrum[static_cast<std::size_t>(ky) * bins];
+            for (unsigned int kx = 0; kx < bins; kx++) {
+                const float fx = static_cast<float>(kx) / width;
+                const float f2 = fx * fx + fy * fy;
+                // The DC bin would only shift the field, which is normalized afterwards
+                if (f2 == 0.0f) {
+                    row[kx] = 0.0f;
+                    continue;
+                }
+                const float amplitude = std::pow(f2, -0.25f * beta);
+                const float phase = binHash(seed, kx, ky) * (2.0f * pi / 4294967296.0f);
+                row[kx] = std::polar(amplitude, phase);
+            }
+        }
+    });
+
+    // The kx = 0 column (and kx = width / 2 for even widths) holds both ky and -ky: make it
+    // Hermitian so that the field is real
+    const unsigned int columns[2] = { 0, width % 2 == 0 ? width / 2 : 0 };
+    for (unsigned int kx : columns) {
+        for (unsigned int ky = 0; ky <= height / 2; ky++) {
+            std::complex<float>& a = spectrum[static_cast<std::size_t>(ky) * bins + kx];
+            const unsigned int mirror = (height - ky) % height;
+            if (mirror == ky) {
+                a = a.real();
+            } else {
+                spectrum[static_cast<std::size_t>(mirror) * bins + kx] = std::conj(a);
+            }
+        }
+    }
+
+    heights.resize(static_cast<std::size_t>(width) * height);
+    inverseRealFFT2D(spectrum, width, height, heights.data());
+
+    const auto range = std::minmax_element(heights.begin(), heights.end());
+    const float low = *range.first;
+    const float scale = *range.second > low ? 1.0f / (*range.second - low) : 0.0f;
+    for (float& v : heights) {
+        v = (v - low) * scale;
+    }
+}
+
+void SpectralNoise::renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, float)
+{
+    const std::vector<float>& values = field();
+    if (mode > 2) mode = 0;
+
+    for (unsigned int y = y0; y < y1; y += step) {
+        for (unsigned int x = x0; x < x1; x += step) {
+            const float v = values[static_cast<std::size_t>(y) * width + x];
+            unsigned char rgb[3];
+            if (mode == 1) {
+                colorOf(kTerrain, v, rgb);
+            } else if (mode == 2) {
+                colorOf(kClouds, v, rgb);
+            } else {
+                colorOf(kGray, v, rgb);
+            }
+            // Each sample covers a step x step block
+            fillBlock(image, width, x, y, std::min(step, x1 - x), std::min(step, y1 - y), rgb[0], rgb[1], rgb[2], 255);
+        }
+    }
+}
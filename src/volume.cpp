@@ -0,0 +1,166 @@
+#include "../include/volume.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr unsigned int kBrick = NoiseVolume::kBrick;
+constexpr unsigned int kRows = kBrick * kBrick;
+constexpr unsigned int kDeltasPerRow = kBrick - 1;
+
+// Differences of -255..255 mapped to 0..510, small magnitudes first
+unsigned int zigzag(int d) {
+    return d >= 0 ? 2u * d : 2u * -d - 1u;
+}
+
+unsigned int bitWidth(unsigned int v) {
+    unsigned int bits = 0;
+    while ((1u << bits) <= v) bits++;
+    return bits;
+}
+
+int unzigzag(unsigned int u) {
+    return (u & 1u) ? -static_cast<int>((u + 1) / 2) : static_cast<int>(u / 2);
+}
+
+}
+
+NoiseVolume::NoiseVolume(unsigned int x, unsigned int y, unsigned int z)
+    : nx(x), ny(y), nz(z),
+      bx((x + kBrick - 1) / kBrick), by((y + kBrick - 1) / kBrick), bz((z + kBrick - 1) / kBrick),
+      bricks(static_cast<std::size_t>(bx) * by * bz)
+{
+}
+
+void NoiseVolume::decodeRow(const Brick& b, unsigned int row, unsigned int count, unsigned char* out)
+{
+    if (b.bits == 0 && b.starts.empty()) {
+        std::memset(out, b.value, count);
+        return;
+    }
+    const std::uint64_t mask = (std::uint64_t(1) << b.bits) - 1;
+    if (b.starts.empty()) {
+        // Offsets from the brick minimum
+        std::size_t pos = static_cast<std::size_t>(row) * kBrick * b.bits;
+        for (unsigned int i = 0; i < count; i++, pos += b.bits) {
+            const std::size_t word = pos >> 6;
+            const unsigned int offset = pos & 63;
+            std::uint64_t u = b.packed[word] >> offset;
+            if (offset + b.bits > 64) {
+                u |= b.packed[word + 1] << (64 - offset);
+            }
+            out[i] = static_cast<unsigned char>(b.value + (u & mask));
+        }
+        return;
+    }
+    int v = b.starts[row];
+    out[0] = static_cast<unsigned char>(v);
+    if (b.bits == 0) {
+        std::memset(out, v, count);
+        return;
+    }
+    std::size_t pos = static_cast<std::size_t>(row) * kDeltasPerRow * b.bits;
+    for (unsigned int i = 1; i < count; i++, pos += b.bits) {
+        const std::size_t word = pos >> 6;
+        const unsigned int offset = pos & 63;
+        std::uint64_t u = b.packed[word] >> offset;
+        if (offset + b.bits > 64) {
+            u |= b.packed[word + 1] << (64 - offset);
+        }
+        v += unzigzag(static_cast<unsigned int>(u & mask));
+        out[i] = static_cast<unsigned char>(v);
+    }
+}
+
+unsigned char NoiseVolume::at(unsigned int x, unsigned int y, unsigned int z) const
+{
+    unsigned char row[kBrick];
+    const unsigned int count = x % kBrick + 1;
+    decodeRow(brick(x / kBrick, y / kBrick, z / kBrick), (z % kBrick) * kBrick + y % kBrick, count, row);
+    return row[count - 1];
+}
+
+void NoiseVolume::readBrick(unsigned int i, unsigned int j, unsigned int k, unsigned char* out) const
+{
+    const Brick& b = brick(i, j, k);
+    for (unsigned int row = 0; row < kRows; row++) {
+        decodeRow(b, row, kBrick, out + row * kBrick);
+    }
+}
+
+std::vector<unsigned char> NoiseVolume::slice(unsigned int z) const
+{
+    std::vector<unsigned char> plane(static_cast<std::size_t>(nx) * ny);
+    unsigned char row[kBrick];
+    for (unsigned int y = 0; y < ny; y++) {
+        for (unsigned int i = 0; i < bx; i++) {
+            const unsigned int count = std::min(kBrick, nx - i * kBrick);
+            decodeRow(brick(i, y / kBrick, z / kBrick), (z % kBrick) * kBrick + y % kBrick, count, row);
+            std::memcpy(&plane[static_cast<std::size_t>(y) * nx + i * kBrick], row, count);
+        }
+    }
+    return plane;
+}
+
+void NoiseVolume::storeBrick(unsigned int i, unsigned int j, unsigned int k, const unsigned char* values)
+{
+    Brick& b = bricks[(static_cast<std::size_t>(k) * by + j) * bx + i];
+    const auto range = std::minmax_element(values, values + kRows * kBrick);
+    const unsigned int low = *range.first;
+
+    // Smooth bricks store small differences along X; detailed ones are cheaper as plain
+    // offsets from their minimum (a uniform brick needs 0 bits of either)
+    unsigned int largest = 0;
+    for (unsigned int row = 0; row < kRows; row++) {
+        const unsigned char* r = values + row * kBrick;
+        for (unsigned int x = 1; x < kBrick; x++) {
+            largest = std::max(largest, zigzag(r[x] - r[x - 1]));
+        }
+    }
+    const unsigned int offsetBits = bitWidth(*range.second - low);
+    const unsigned int deltaBits = bitWidth(largest);
+    const bool delta = kRows * (8 + kDeltasPerRow * deltaBits) < kRows * kBrick * offsetBits;
+    const unsigned int bits = delta ? deltaBits : offsetBits;
+
+    b.bits = static_cast<unsigned char>(bits);
+    b.value = static_cast<unsigned char>(low);
+    b.starts.clear();
+    b.packed.assign((static_cast<std::size_t>(kRows) * kBrick * bits + 63) / 64, 0);
+    if (delta) {
+        b.starts.resize(kRows);
+    }
+    std::size_t pos = 0;
+    auto put = [&](std::uint64_t u) {
+        const std::size_t word = pos >> 6;
+        const unsigned int offset = pos & 63;
+        b.packed[word] |= u << offset;
+        if (offset + bits > 64) {
+            b.packed[word + 1] |= u >> (64 - offset);
+        }
+        pos += bits;
+    };
+    for (unsigned int row = 0; row < kRows; row++) {
+        const unsigned char* r = values + row * kBrick;
+        if (delta) {
+            b.starts[row] = r[0];
+        }
+        if (bits == 0) continue;
+        if (delta) {
+            for (unsigned int x = 1; x < kBrick; x++) put(zigzag(r[x] - r[x - 1]));
+        } else {
+            for (unsigned int x = 0; x < kBrick; x++) put(r[x] - low);
+        }
+    }
+    b.packed.resize((pos + 63) / 64);
+    b.starts.shrink_to_fit();
+    b.packed.shrink_to_fit();
+}
+
+std::size_t NoiseVolume::memoryUsage() const
+{
+    std::size_t bytes = bricks.size() * sizeof(Brick);
+    for (const Brick& b : bricks) {
+        bytes += b.starts.capacity() + b.packed.capacity() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
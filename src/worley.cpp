@@ -0,0 +1,264 @@
+#include "../include/worley.hpp"
+#include "../include/image_utils.hpp"
+#include "../include/parallel.hpp"
+#include "../include/bits.hpp"
+#include "../include/lattice.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Points per thread below which a region is not split
+constexpr unsigned int kParallelGrain = 1u << 13;
+// Value of each output mapped to white (Euclidean distances with full jitter)
+constexpr float kDisplayRange[3] = { 1.0f, 1.5f, 1.0f };
+
+// Position of the feature point inside its cell: the low and high halves of the hash
+inline float featureOffset(std::uint32_t bits, float jitter) {
+    return 0.5f + jitter * (static_cast<float>(bits) * (1.0f / 65536.0f) - 0.5f);
+}
+
+// Distances are compared squared for the Euclidean metric; the root is taken at the end
+template <WorleyMetric M>
+inline float distance(float dx, float dy) {
+    if constexpr (M == WorleyMetric::Euclidean) {
+        return dx * dx + dy * dy;
+    } else if constexpr (M == WorleyMetric::Manhattan) {
+        return std::fabs(dx) + std::fabs(dy);
+    } else {
+        return std::max(std::fabs(dx), std::fabs(dy));
+    }
+}
+
+// Scans the rings of cells at Chebyshev distance `first` and beyond around cell (cx, cy),
+// keeping the two smallest distances. `(fx, fy)` is the position of the point in its cell.
+template <WorleyMetric M>
+void scanRings(std::uint32_t seed, float jitter, std::int32_t cx, std::int32_t cy, float fx, float fy,
+    int first, float& f1, float& f2)
+{
+    // The nearest cell of ring r is r - 1 cells past the closest edge of the point's cell
+    const float edge = std::min(std::min(fx, 1.0f - fx), std::min(fy, 1.0f - fy));
+    for (int r = first; r < 2 || distance<M>(r - 1 + edge, 0.0f) < f2; r++) {
+        for (int j = -r; j <= r; j++) {
+            const float gy = j > 0 ? j - fy : (j < 0 ? -j - 1 + fy : 0.0f);
+            const int stride = (j == -r || j == r) ? 1 : 2 * r;
+            for (int i = -r; i <= r; i += std::max(stride, 1)) {
+                // Early out: the whole cell is farther than the second nearest point
+                const float gx = i > 0 ? i - fx : (i < 0 ? -i - 1 + fx : 0.0f);
+                if (distance<M>(gx, gy) >= f2) continue;
+                const std::uint32_t h = latticeHash(seed, cx + i, cy + j);
+                const float d = distance<M>(static_cast<float>(i) - fx + featureOffset(h & 0xffffu, jitter),
+                                            static_cast<float>(j) - fy + featureOffset(h >> 16, jitter));
+                f2 = std::min(f2, std::max(f1, d));
+                f1 = std::min(f1, d);
+            }
+        }
+    }
+}
+
+#if defined(__AVX2__)
+
+template <WorleyMetric M>
+inline __m256 distance8(__m256 dx, __m256 dy) {
+    if constexpr (M == WorleyMetric::Euclidean) {
+        return _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+    } else {
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        const __m256 ax = _mm256_andnot_ps(sign, dx);
+        const __m256 ay = _mm256_andnot_ps(sign, dy);
+        return M == WorleyMetric::Manhattan ? _mm256_add_ps(ax, ay) : _mm256_max_ps(ax, ay);
+    }
+}
+
+// F1 and F2 of eight points per iteration over the 3x3 block of cells, which settles nearly
+// every point; the lanes that could still find a closer point farther out finish in scalar.
+// Returns how many points were processed.
+template <WorleyMetric M>
+std::size_t worleyBatchSimd(std::uint32_t seed, float jitter, const float* xs, const float* ys,
+    float* f1, float* f2, std::size_t count)
+{
+    const __m256i hashSeed = _mm256_set1_epi32(static_cast<int>(seed));
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 unit = _mm256_set1_ps(1.0f / 65536.0f);
+    const __m256 spread = _mm256_set1_ps(jitter);
+    const __m256i low16 = _mm256_set1_epi32(0xffff);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(xs + i);
+        const __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 floorX = _mm256_floor_ps(x);
+        const __m256 floorY = _mm256_floor_ps(y);
+        const __m256i cx = _mm256_cvttps_epi32(floorX);
+        const __m256i cy = _mm256_cvttps_epi32(floorY);
+        const __m256 fx = _mm256_sub_ps(x, floorX);
+        const __m256 fy = _mm256_sub_ps(y, floorY);
+
+        __m256 d1 = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+        __m256 d2 = d1;
+        for (int j = -1; j <= 1; j++) {
+            const __m256i cellY = _mm256_add_epi32(cy, _mm256_set1_epi32(j));
+            const __m256 baseY = _mm256_sub_ps(_mm256_set1_ps(static_cast<float>(j)), fy);
+            for (int k = -1; k <= 1; k++) {
+                const __m256i h = latticeHash8(_mm256_add_epi32(cx, _mm256_set1_epi32(k)), cellY, hashSeed);
+                const __m256 ox = _mm256_add_ps(half, _mm256_mul_ps(spread,
+                    _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(h, low16)), unit), half)));
+                const __m256 oy = _mm256_add_ps(half, _mm256_mul_ps(spread,
+                    _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 16)), unit), half)));
+                const __m256 dx = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(static_cast<float>(k)), fx), ox);
+                const __m256 dy = _mm256_add_ps(baseY, oy);
+                const __m256 d = distance8<M>(dx, dy);
+                d2 = _mm256_min_ps(d2, _mm256_max_ps(d1, d));
+                d1 = _mm256_min_ps(d1, d);
+            }
+        }
+        _mm256_storeu_ps(f1 + i, d1);
+        _mm256_storeu_ps(f2 + i, d2);
+
+        // Lanes whose second nearest point could lie in the ring around the 3x3 block
+        const __m256 edge = _mm256_min_ps(_mm256_min_ps(fx, _mm256_sub_ps(one, fx)), _mm256_min_ps(fy, _mm256_sub_ps(one, fy)));
+        const __m256 bound = distance8<M>(_mm256_add_ps(one, edge), _mm256_setzero_ps());
+        int pending = _mm256_movemask_ps(_mm256_cmp_ps(bound, d2, _CMP_LT_OQ));
+        if (pending) {
+            alignas(32) std::int32_t cellsX[8], cellsY[8];
+            alignas(32) float fracX[8], fracY[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(cellsX), cx);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(cellsY), cy);
+            _mm256_store_ps(fracX, fx);
+            _mm256_store_ps(fracY, fy);
+            for (; pending; pending &= pending - 1) {
+                const int l = ctz32(static_cast<std::uint32_t>(pending));
+                scanRings<M>(seed, jitter, cellsX[l], cellsY[l], fracX[l], fracY[l], 2, f1[i + l], f2[i + l]);
+            }
+        }
+    }
+    return i;
+}
+
+#else
+
+template <WorleyMetric M>
+std::size_t worleyBatchSimd(std::uint32_t, float, const float*, const float*, float*, float*, std::size_t) { return 0; }
+
+#endif
+
+template <WorleyMetric M>
+void distances(std::uint32_t seed, float jitter, const float* xs, const float* ys, float* f1, float* f2, std::size_t count)
+{
+    std::size_t i = worleyBatchSimd<M>(seed, jitter, xs, ys, f1, f2, count);
+    for (; i < count; i++) {
+        const float floorX = std::floor(xs[i]);
+        const float floorY = std::floor(ys[i]);
+        f1[i] = f2[i] = std::numeric_limits<float>::infinity();
+        scanRings<M>(seed, jitter, static_cast<std::int32_t>(floorX), static_cast<std::int32_t>(floorY),
+            xs[i] - floorX, ys[i] - floorY, 0, f1[i], f2[i]);
+    }
+    if constexpr (M == WorleyMetric::Euclidean) {
+        for (i = 0; i < count; i++) {
+            f1[i] = std::sqrt(f1[i]);
+            f2[i] = std::sqrt(f2[i]);
+        }
+    }
+}
+
+}
+
+WorleyNoise::WorleyNoise(unsigned int w, unsigned int h, unsigned int s)
+    : width(w), height(h)
+{
+    scale = 10.0f;
+    seed = s;
+    output = WorleyOutput::F1;
+    metric = WorleyMetric::Euclidean;
+    jitter = 1.0f;
+    originX = 0.0;
+    originY = 0.0;
+}
+
+std::vector<unsigned char> WorleyNoise::generateImage(std::string& imageName)
+{
+    std::vector<unsigned char> image(width * height * 4);
+    renderRegion(image, 0, 0, width, height);
+    imageName = "../assets/worley_noise_" + generateUniqueFileName();
+    return image;
+}
+
+void WorleyNoise::distanceBatch(const float* xs, const float* ys, float* f1, float* f2, std::size_t count)
+{
+    if (metric == WorleyMetric::Manhattan) {
+        distances<WorleyMetric::Manhattan>(seed, jitter, xs, ys, f1, f2, count);
+    } else if (metric == WorleyMetric::Chebyshev) {
+        distances<WorleyMetric::Chebyshev>(seed, jitter, xs, ys, f1, f2, count);
+    } else {
+        distances<WorleyMetric::Euclidean>(seed, jitter, xs, ys, f1, f2, count);
+    }
+}
+
+void WorleyNoise::noiseBatch(const float* xs, const float* ys, float* out, std::size_t count)
+{
+    std::vector<float> f2(count);
+    distanceBatch(xs, ys, out, f2.data(), count);
+    for (std::size_t i = 0; i < count; i++) {
+        out[i] = output == WorleyOutput::F1 ? out[i] : (output == WorleyOutput::F2 ? f2[i] : f2[i] - out[i]);
+    }
+}
+
+std::vector<float> WorleyNoise::generateField()
+{
+    std::vector<float> field(static_cast<std::size_t>(width) * height);
+    renderField(field, 0, 0, width, height);
+    return field;
+}
+
+void WorleyNoise::renderField(std::vector<float>& field, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1)
+{
+    evaluateRegion(x0, y0, x1, y1, 1, [&](unsigned int y, const float* values) {
+        std::copy(values, values + (x1 - x0), &field[static_cast<std::size_t>(y) * width + x0]);
+    });
+}
+
+void WorleyNoise::renderRegion(std::vector<unsigned char>& image, unsigned int x0, unsigned int y0,
+    unsigned int x1, unsigned int y1, unsigned int step, float)
+{
+    const unsigned int samples = (x1 - x0 + step - 1) / step;
+    const float white = 255.0f / kDisplayRange[static_cast<int>(output)];
+    evaluateRegion(x0, y0, x1, y1, step, [&](unsigned int y, const float* values) {
+        for (unsigned int s = 0; s < samples; s++) {
+            const unsigned int x = x0 + s * step;
+            const unsigned char v = static_cast<unsigned char>(std::min(values[s] * white, 255.0f));
+            // Each sample covers a step x step block
+            fillBlock(image, width, x, y, std::min(step, x1 - x), std::min(step, y1 - y), v, v, v, 255);
+        }
+    });
+}
+
+void WorleyNoise::evaluateRegion(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1,
+    unsigned int step, const std::function<void(unsigned int, const float*)>& emit)
+{
+    const unsigned int samples = (x1 - x0 + step - 1) / step;
+    const unsigned int rows = (y1 - y0 + step - 1) / step;
+    std::vector<float> xs(samples);
+    for (unsigned int s = 0; s < samples; s++) {
+        xs[s] = static_cast<float>((originX + x0 + s * step) / width * scale);
+    }
+
+    parallelFor(0, rows, kParallelGrain / std::max(samples, 1u) + 1, [&](unsigned int first, unsigned int last) {
+        std::vector<float> ys(samples), f1(samples), f2(samples);
+        for (unsigned int j = first; j < last; j++) {
+            const unsigned int y = y0 + j * step;
+            std::fill(ys.begin(), ys.end(), static_cast<float>((originY + y) / height * scale));
+            distanceBatch(xs.data(), ys.data(), f1.data(), f2.data(), samples);
+            if (output == WorleyOutput::F2) {
+                f1.swap(f2);
+            } else if (output == WorleyOutput::F2MinusF1) {
+                for (unsigned int s = 0; s < samples; s++) f1[s] = f2[s] - f1[s];
+            }
+            emit(y, f1.data());
+        }
+    });
+}